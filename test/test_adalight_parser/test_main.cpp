@@ -0,0 +1,192 @@
+/*
+ * Host tests for the Adalight and TPM2 serial framing (AdalightParser), run with `pio test -e native`
+ * Recorded byte streams are fed the way handleSerial() does, with the bulk pixel copy and byte by byte.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+
+#include "adalight_parser.cpp"
+
+#define TEST_CHUNK_PIXELS 64
+
+// what handleSerial() would have done with a stream
+struct Result {
+  std::vector<uint8_t> pixels;     // 3 bytes per pixel as set
+  std::vector<uint16_t> frameLen;  // pixels set by each shown frame
+  std::vector<uint8_t> commands;
+  uint16_t pings = 0;
+};
+
+// arrival: bytes available per read, 0 for all at once; bulk: use the bulk pixel copy
+static Result run(const std::vector<uint8_t>& stream, size_t arrival, bool bulk)
+{
+  AdalightParser ada;
+  Result r;
+  uint16_t framePixels = 0;
+  size_t pos = 0, received = 0;
+  auto setPixel = [&](uint16_t i, const uint8_t* rgb) {
+    if (r.pixels.size() < (i + 1u) * 3) r.pixels.resize((i + 1u) * 3, 0);
+    memcpy(&r.pixels[i * 3], rgb, 3);
+    framePixels++;
+  };
+  auto frameDone = [&]() { r.frameLen.push_back(framePixels); framePixels = 0; };
+
+  while (pos < stream.size()) {
+    received = arrival ? ((received + arrival < stream.size()) ? received + arrival : stream.size()) : stream.size();
+    while (pos < received) {
+      uint16_t n = bulk ? ada.bulkPixels() : 0;
+      if (n && received - pos >= 3) {
+        if (n > (received - pos) / 3) n = (received - pos) / 3;
+        if (n > TEST_CHUNK_PIXELS) n = TEST_CHUNK_PIXELS;
+        uint16_t first = ada.nextPixel();
+        for (uint16_t i = 0; i < n; i++) setPixel(first + i, &stream[pos + i * 3]);
+        pos += n * 3;
+        if (ada.bulkRead(n)) frameDone();
+        continue;
+      }
+      uint8_t next = stream[pos++];
+      uint8_t event = ada.feed(next);
+      switch (event) {
+        case ADALIGHT_COMMAND: r.commands.push_back(next); break;
+        case ADALIGHT_PING:    r.pings++; break;
+        case ADALIGHT_PIXEL:
+        case ADALIGHT_FRAME: {
+          uint8_t rgb[3] = { ada.red, ada.green, ada.blue };
+          setPixel(ada.pixelIndex(), rgb);
+          if (event == ADALIGHT_FRAME) frameDone();
+        } break;
+      }
+    }
+  }
+  return r;
+}
+
+static void adalightFrame(std::vector<uint8_t>& s, uint16_t pixels, uint8_t seed)
+{
+  uint16_t n = pixels - 1;
+  s.push_back('A'); s.push_back('d'); s.push_back('a');
+  s.push_back(n >> 8); s.push_back(n & 0xFF); s.push_back((n >> 8) ^ (n & 0xFF) ^ 0x55);
+  for (uint32_t i = 0; i < pixels * 3u; i++) s.push_back((uint8_t)(i * 13 + seed));
+}
+
+static void tpm2Frame(std::vector<uint8_t>& s, uint16_t bytes, uint8_t seed)
+{
+  s.push_back(0xC9); s.push_back(0xDA); s.push_back(bytes >> 8); s.push_back(bytes & 0xFF);
+  for (uint32_t i = 0; i < bytes; i++) s.push_back((uint8_t)(i * 7 + seed));
+  s.push_back(0x36); // end byte, ignored like any other byte between frames
+}
+
+// every way of receiving and copying a stream gives the same result
+static void checkAllWays(const std::vector<uint8_t>& stream, Result& out)
+{
+  out = run(stream, 0, false);
+  const size_t arrivals[] = { 0, 1, 2, 3, 5, 64, 200 };
+  for (size_t a : arrivals) {
+    Result r = run(stream, a, true);
+    TEST_ASSERT_TRUE(r.pixels == out.pixels);
+    TEST_ASSERT_TRUE(r.frameLen == out.frameLen);
+    TEST_ASSERT_TRUE(r.commands == out.commands);
+    TEST_ASSERT_EQUAL_UINT16(out.pings, r.pings);
+  }
+}
+
+void test_adalight_frame() {
+  std::vector<uint8_t> s;
+  adalightFrame(s, 300, 1);
+  Result r;
+  checkAllWays(s, r);
+  TEST_ASSERT_EQUAL_UINT32(1, r.frameLen.size());
+  TEST_ASSERT_EQUAL_UINT16(300, r.frameLen[0]);
+  TEST_ASSERT_EQUAL_UINT32(900, r.pixels.size());
+  TEST_ASSERT_EQUAL_MEMORY(&s[6], &r.pixels[0], 900);
+  TEST_ASSERT_TRUE(r.commands.empty());
+}
+
+void test_adalight_single_pixel() {
+  std::vector<uint8_t> s;
+  adalightFrame(s, 1, 9);
+  adalightFrame(s, 1, 10);
+  Result r;
+  checkAllWays(s, r);
+  TEST_ASSERT_EQUAL_UINT32(2, r.frameLen.size());
+  TEST_ASSERT_EQUAL_UINT8(10, r.pixels[0]);
+}
+
+// a bad checksum drops the header, its data bytes are then read as commands
+void test_adalight_bad_checksum() {
+  std::vector<uint8_t> s;
+  adalightFrame(s, 2, 1);
+  s[5] ^= 1;
+  adalightFrame(s, 2, 50);
+  Result r;
+  checkAllWays(s, r);
+  TEST_ASSERT_EQUAL_UINT32(1, r.frameLen.size());
+  TEST_ASSERT_EQUAL_UINT8(50, r.pixels[0]);
+  TEST_ASSERT_EQUAL_UINT32(6, r.commands.size()); // the data bytes, none of them starts a frame
+}
+
+// garbage and interrupted headers between frames resync on the next 'Ada'
+void test_resync() {
+  std::vector<uint8_t> s = { 'x', 'A', 'x', 'A', 'd', 'x', 'v' };
+  adalightFrame(s, 3, 20);
+  Result r;
+  checkAllWays(s, r);
+  TEST_ASSERT_EQUAL_UINT32(1, r.frameLen.size());
+  TEST_ASSERT_EQUAL_UINT16(3, r.frameLen[0]);
+  TEST_ASSERT_EQUAL_UINT8(20, r.pixels[0]);
+  const uint8_t commands[] = { 'x', 'v' }; // bytes after a failed header byte start over, they are not commands
+  TEST_ASSERT_EQUAL_UINT32(2, r.commands.size());
+  TEST_ASSERT_EQUAL_MEMORY(commands, r.commands.data(), 2);
+}
+
+void test_tpm2_frames_and_ping() {
+  std::vector<uint8_t> s = { 0xC9, 0xAA };
+  tpm2Frame(s, 3 * 200, 3);
+  tpm2Frame(s, 0, 0);                // empty frame
+  tpm2Frame(s, 7, 5);                // incomplete last pixel is not shown
+  Result r;
+  checkAllWays(s, r);
+  TEST_ASSERT_EQUAL_UINT16(1, r.pings);
+  TEST_ASSERT_EQUAL_UINT32(2, r.frameLen.size());
+  TEST_ASSERT_EQUAL_UINT16(200, r.frameLen[0]);
+  TEST_ASSERT_EQUAL_UINT16(2, r.frameLen[1]);
+  for (uint8_t i = 0; i < 6; i++) TEST_ASSERT_EQUAL_UINT8(i * 7 + 5, r.pixels[i]);   // the last frame
+  TEST_ASSERT_EQUAL_MEMORY(&s[6 + 6], &r.pixels[6], 3 * 198);                        // the first one
+}
+
+// frames of different sizes and protocols back to back, as streamed by a PC
+void test_mixed_stream() {
+  std::vector<uint8_t> s;
+  for (uint16_t f = 0; f < 20; f++) {
+    if (f & 1) tpm2Frame(s, (f * 37 % 500 + 1) * 3, f);
+    else       adalightFrame(s, f * 53 % 700 + 1, f);
+  }
+  Result r;
+  checkAllWays(s, r);
+  TEST_ASSERT_EQUAL_UINT32(20, r.frameLen.size());
+  for (uint16_t f = 0; f < 20; f++) TEST_ASSERT_EQUAL_UINT16((f & 1) ? f * 37 % 500 + 1 : f * 53 % 700 + 1, r.frameLen[f]);
+  TEST_ASSERT_EQUAL_UINT32(10, r.commands.size()); // the TPM2 end bytes
+}
+
+// 65536 pixels do not fit the pixel counter and are rejected
+void test_adalight_count_overflow() {
+  std::vector<uint8_t> s = { 'A', 'd', 'a', 0xFF, 0xFF, 0x55 };
+  AdalightParser ada;
+  for (uint8_t b : s) ada.feed(b);
+  TEST_ASSERT_TRUE(ada.idle());
+  TEST_ASSERT_EQUAL_UINT16(0, ada.bulkPixels());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_adalight_frame);
+  RUN_TEST(test_adalight_single_pixel);
+  RUN_TEST(test_adalight_bad_checksum);
+  RUN_TEST(test_resync);
+  RUN_TEST(test_tpm2_frames_and_ping);
+  RUN_TEST(test_mixed_stream);
+  RUN_TEST(test_adalight_count_overflow);
+  return UNITY_END();
+}
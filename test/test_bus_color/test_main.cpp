@@ -0,0 +1,155 @@
+/*
+ * Host tests for the bus color math (bus_color.h), run with `pio test -e native`
+ */
+
+#include <unity.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "bus_color.h"
+
+// light output of an APA102 channel relative to full, in 8 bit units
+static double apa102Output(uint8_t c, uint8_t gb) { return c * gb / 31.0; }
+
+void test_apa102_off() {
+  uint8_t r = 0, g = 0, b = 0;
+  TEST_ASSERT_EQUAL_UINT8(0, apa102Split(r, g, b, 255));
+  TEST_ASSERT_EQUAL_UINT8(0, r | g | b);
+}
+
+void test_apa102_full() {
+  uint8_t r = 255, g = 255, b = 255;
+  TEST_ASSERT_EQUAL_UINT8(31, apa102Split(r, g, b, 255));
+  TEST_ASSERT_EQUAL_UINT8(255, r);
+  TEST_ASSERT_EQUAL_UINT8(255, g);
+  TEST_ASSERT_EQUAL_UINT8(255, b);
+}
+
+// brightness 0 is off, the sweep's one step tolerance would allow a faint glow
+void test_apa102_bri_zero() {
+  for (uint16_t v = 1; v < 256; v++) {
+    uint8_t r = v, g = 255, b = v / 2;
+    TEST_ASSERT_EQUAL_UINT8(0, apa102Split(r, g, b, 0));
+    TEST_ASSERT_EQUAL_UINT8(0, r);
+    TEST_ASSERT_EQUAL_UINT8(0, g);
+    TEST_ASSERT_EQUAL_UINT8(0, b);
+  }
+  uint8_t r = 255, g = 1, b = 0; // lowest level that is not black
+  TEST_ASSERT_EQUAL_UINT8(1, apa102Split(r, g, b, 1));
+  TEST_ASSERT_TRUE(r > 0);
+}
+
+// the split reproduces the brightness scaled intensity within one 8 bit step,
+// uses the lowest global brightness that can show the brightest channel and never loses resolution to scaleBri()
+void test_apa102_split_sweep() {
+  uint32_t checked = 0;
+  for (uint16_t bri = 0; bri < 256; bri += 3) {
+    for (uint16_t v = 0; v < 256; v += 5) {
+      const uint8_t in[3] = { (uint8_t)v, (uint8_t)(v / 2), (uint8_t)(255 - v) };
+      uint8_t r = in[0], g = in[1], b = in[2];
+      uint8_t gb = apa102Split(r, g, b, bri);
+      TEST_ASSERT_TRUE(gb <= 31);
+      const uint8_t out[3] = { r, g, b };
+
+      uint32_t tmax = 0;
+      for (uint8_t i = 0; i < 3; i++) {
+        uint32_t t = in[i] * (bri + 1u);
+        if (t > tmax) tmax = t;
+        double want = t / 256.0;
+        TEST_ASSERT_TRUE(fabs(apa102Output(out[i], gb) - want) <= 1.0);
+      }
+      if (tmax < 256) { TEST_ASSERT_EQUAL_UINT8(0, gb); TEST_ASSERT_EQUAL_UINT8(0, r | g | b); continue; } // scaleBri() gives black
+      TEST_ASSERT_TRUE(gb * 65280u >= tmax * 31u);        // bright enough for the brightest channel
+      TEST_ASSERT_TRUE((gb - 1) * 65280u < tmax * 31u);   // and not brighter than needed
+
+      uint8_t outMax = out[0] > out[1] ? out[0] : out[1];
+      if (out[2] > outMax) outMax = out[2];
+      uint8_t scaledMax = (uint8_t)(tmax >> 8);
+      TEST_ASSERT_TRUE(outMax >= scaledMax);
+      checked++;
+    }
+  }
+  TEST_ASSERT_TRUE(checked > 1000);
+}
+
+// dim levels keep close to 8 bit color resolution
+void test_apa102_dim_resolution() {
+  uint8_t r = 255, g = 200, b = 17;
+  uint8_t gb = apa102Split(r, g, b, 10);
+  TEST_ASSERT_EQUAL_UINT8(2, gb);
+  TEST_ASSERT_TRUE(r >= 128);               // scaleBri() would leave 10 steps
+  TEST_ASSERT_TRUE(abs((int)g - 200 * r / 255) <= 1);
+  TEST_ASSERT_TRUE(abs((int)b - 17 * r / 255) <= 1);
+}
+
+void test_scale_bri() {
+  TEST_ASSERT_EQUAL_HEX32(0xFF804001, scaleBri(0xFF804001, 255));
+  TEST_ASSERT_EQUAL_HEX32(0, scaleBri(0xFFFFFFFF, 0) & 0xFEFEFEFE);
+  for (uint16_t b = 0; b < 256; b++) {
+    uint32_t c = scaleBri(0xFF80400A, b);
+    TEST_ASSERT_EQUAL_UINT8((0xFF * (b + 1)) >> 8, c >> 24);
+    TEST_ASSERT_EQUAL_UINT8((0x80 * (b + 1)) >> 8, c >> 16);
+    TEST_ASSERT_EQUAL_UINT8((0x40 * (b + 1)) >> 8, c >> 8);
+    TEST_ASSERT_EQUAL_UINT8((0x0A * (b + 1)) >> 8, c);
+  }
+}
+
+// the span version used by the network senders matches the per channel result for any length and alignment
+void test_scale_bri_span() {
+  uint8_t src[40], dst[41];
+  for (uint8_t i = 0; i < sizeof(src); i++) src[i] = i * 37 + 5;
+  for (uint8_t n = 0; n < 39; n++) {
+    memset(dst, 0xAA, sizeof(dst));
+    scaleBriSpan(dst + 1, src + 1, n, 100);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, dst[0]);
+    for (uint8_t i = 0; i < n; i++) TEST_ASSERT_EQUAL_UINT8((src[i + 1] * 101) >> 8, dst[i + 1]);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, dst[n + 1]);
+  }
+}
+
+// over 256 frames the dithered output adds up to the exact scaled intensity of each channel
+void test_scale_bri_dither() {
+  uint8_t res[4] = { 0 };
+  uint32_t sum[4] = { 0 };
+  for (uint16_t n = 0; n < 256; n++) {
+    uint32_t c = scaleBriDither(0xFF80400A, 100, res);
+    for (uint8_t i = 0; i < 4; i++) sum[i] += uint8_t(c >> (i*8));
+  }
+  TEST_ASSERT_EQUAL_UINT32(0x0A * 101, sum[0]);
+  TEST_ASSERT_EQUAL_UINT32(0x40 * 101, sum[1]);
+  TEST_ASSERT_EQUAL_UINT32(0x80 * 101, sum[2]);
+  TEST_ASSERT_EQUAL_UINT32(0xFF * 101, sum[3]);
+}
+
+// brightness 0 is black in every frame, whatever was carried, and clears the carry
+void test_scale_bri_dither_off() {
+  uint8_t res[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+  for (uint16_t n = 0; n < 256; n++) TEST_ASSERT_EQUAL_HEX32(0, scaleBriDither(0xFFFFFFFF, 0, res));
+  for (uint8_t i = 0; i < 4; i++) TEST_ASSERT_EQUAL_UINT8(0, res[i]);
+  TEST_ASSERT_EQUAL_HEX32(0, scaleBriDither(0x01010101, 1, res)); // no leftover from before it was off
+}
+
+void test_to_wire_order() {
+  // shifts as in BusDigital::colorOrderShifts
+  const uint8_t grb[3] = { 16, 8, 0 };
+  TEST_ASSERT_EQUAL_HEX32(0x44112233, toWireOrder(0x44112233, grb));
+  const uint8_t rgb[3] = { 8, 16, 0 };
+  TEST_ASSERT_EQUAL_HEX32(0x44221133, toWireOrder(0x44112233, rgb));
+  const uint8_t gbr[3] = { 0, 8, 16 };
+  TEST_ASSERT_EQUAL_HEX32(0x44332211, toWireOrder(0x44112233, gbr));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_apa102_off);
+  RUN_TEST(test_apa102_full);
+  RUN_TEST(test_apa102_bri_zero);
+  RUN_TEST(test_apa102_split_sweep);
+  RUN_TEST(test_apa102_dim_resolution);
+  RUN_TEST(test_scale_bri);
+  RUN_TEST(test_scale_bri_span);
+  RUN_TEST(test_scale_bri_dither);
+  RUN_TEST(test_scale_bri_dither_off);
+  RUN_TEST(test_to_wire_order);
+  return UNITY_END();
+}
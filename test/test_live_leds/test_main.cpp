@@ -0,0 +1,174 @@
+/*
+ * Host tests for the compressed live LED stream (live_leds.cpp), run with `pio test -e native`
+ * Encoded messages are checked with a decoder written from the format description in live_leds.h.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "live_leds.cpp"
+
+static std::vector<uint32_t> strip;  // pixel colors read by the encoder
+static uint32_t reads = 0;
+
+static void readStrip(uint16_t first, uint32_t* colors, uint16_t count)
+{
+  TEST_ASSERT_TRUE(count <= LIVE_LEDS_READ_CHUNK);
+  TEST_ASSERT_TRUE(first + count <= strip.size());
+  memcpy(colors, &strip[first], count * sizeof(uint32_t));
+  reads++;
+}
+
+// applies one message (header and records) to the pixels as a client would, returns false if it is malformed
+static bool decode(const uint8_t* msg, uint16_t len, std::vector<uint32_t>& pixels)
+{
+  if (len < LIVE_LEDS_HEADER_LEN || msg[0] != 'L' || msg[1] != 2) return false;
+  const bool rgbw = msg[2] & 0x01;
+  const uint8_t bpp = rgbw ? 4 : 3;
+  const uint16_t total = (msg[4] << 8) | msg[5];
+  uint16_t pix = (msg[6] << 8) | msg[7];
+  const uint16_t end = pix + ((msg[8] << 8) | msg[9]);
+  if (end > total) return false;
+  if (msg[2] & 0x02) pixels.assign(total, 0);
+  if (pixels.size() != total) return false;
+
+  uint16_t pos = LIVE_LEDS_HEADER_LEN;
+  auto color = [&](const uint8_t* p) {
+    return ((uint32_t)(rgbw ? p[3] : 0) << 24) | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+  };
+  while (pos < len) {
+    uint8_t c = msg[pos++];
+    if (c < 0x80) {                       // unchanged
+      pix += c + 1;
+    } else if (c < 0xC0) {                // repeat
+      if (pos + bpp > len) return false;
+      uint32_t col = color(msg + pos); pos += bpp;
+      for (uint8_t i = 0; i <= (c & 0x3F); i++) { if (pix >= end) return false; pixels[pix++] = col; }
+    } else {                              // literal
+      for (uint8_t i = 0; i <= (c & 0x3F); i++) {
+        if (pos + bpp > len || pix >= end) return false;
+        pixels[pix++] = color(msg + pos); pos += bpp;
+      }
+    }
+    if (pix > end) return false;
+  }
+  return pix == end;
+}
+
+// encodes pixels [0, strip.size()) in messages of at most maxLen bytes and decodes them, returns the bytes sent
+static uint32_t stream(std::vector<uint32_t>& client, uint32_t* prev, bool rgbw, bool reset, uint16_t maxLen)
+{
+  std::vector<uint8_t> msg(LIVE_LEDS_HEADER_LEN + maxLen + 16, 0xEE);
+  const uint16_t used = strip.size();
+  uint16_t pix = 0;
+  uint32_t sent = 0;
+  do {
+    uint16_t first = pix;
+    uint16_t len = LIVE_LEDS_HEADER_LEN + encodeLiveLeds(&msg[LIVE_LEDS_HEADER_LEN], maxLen, pix, used, prev, rgbw, readStrip);
+    writeLiveLedsHeader(&msg[0], rgbw, reset && first == 0, 128, used, first, pix - first);
+    TEST_ASSERT_TRUE(len <= LIVE_LEDS_HEADER_LEN + maxLen);
+    TEST_ASSERT_EQUAL_HEX8(0xEE, msg[LIVE_LEDS_HEADER_LEN + maxLen]); // nothing written past maxLen
+    TEST_ASSERT_TRUE(pix > first || !used);                          // progress with every message
+    TEST_ASSERT_TRUE(decode(&msg[0], len, client));
+    sent += len;
+  } while (pix < used);
+  return sent;
+}
+
+static uint32_t randomColor(bool rgbw) { return ((uint32_t)rand() << 8 ^ rand()) & (rgbw ? 0xFFFFFFFF : 0x00FFFFFF); }
+
+void setUp() { srand(1); reads = 0; }
+
+void test_header() {
+  uint8_t h[LIVE_LEDS_HEADER_LEN];
+  writeLiveLedsHeader(h, true, true, 77, 0x1234, 0x0100, 0x00FF);
+  const uint8_t expected[LIVE_LEDS_HEADER_LEN] = { 'L', 2, 0x03, 77, 0x12, 0x34, 0x01, 0x00, 0x00, 0xFF };
+  TEST_ASSERT_EQUAL_MEMORY(expected, h, LIVE_LEDS_HEADER_LEN);
+  writeLiveLedsHeader(h, false, false, 255, 1, 0, 1);
+  TEST_ASSERT_EQUAL_HEX8(0x00, h[2]);
+}
+
+// full frames without previous colors decode to the strip contents, in one message or many
+void test_full_frame_round_trip() {
+  for (uint8_t rgbw = 0; rgbw < 2; rgbw++) {
+    strip.resize(1000);
+    for (uint16_t i = 0; i < strip.size(); i++) {
+      // runs of equal colors of varying length between random ones
+      strip[i] = (i % 97 < 40) ? (0x00102030u | (rgbw ? 0x40000000u : 0)) * (i / 97 + 1) : randomColor(rgbw);
+    }
+    const uint16_t sizes[] = { 4096, 1024, 256, 64, 17, 5 };
+    for (uint16_t maxLen : sizes) {
+      std::vector<uint32_t> client;
+      stream(client, nullptr, rgbw, true, maxLen);
+      TEST_ASSERT_TRUE(client == strip);
+    }
+  }
+}
+
+// runs of one color are sent as repeat records of at most 64 pixels
+void test_repeat_records() {
+  strip.assign(200, 0x00ABCDEF);
+  uint8_t buf[64];
+  uint16_t pix = 0;
+  uint16_t len = encodeLiveLeds(buf, sizeof(buf), pix, strip.size(), nullptr, false, readStrip);
+  TEST_ASSERT_EQUAL_UINT16(200, pix);
+  TEST_ASSERT_EQUAL_UINT16(4 * 4, len);    // 64 + 64 + 64 + 8 pixels
+  const uint8_t expected[] = { 0xBF, 0xAB, 0xCD, 0xEF, 0xBF, 0xAB, 0xCD, 0xEF, 0xBF, 0xAB, 0xCD, 0xEF, 0x87, 0xAB, 0xCD, 0xEF };
+  TEST_ASSERT_EQUAL_MEMORY(expected, buf, sizeof(expected));
+}
+
+// a color repeating after a literal run ends the literal and starts a repeat record
+void test_literal_to_repeat() {
+  strip = { 1, 2, 3, 3, 3, 4 };
+  uint8_t buf[64];
+  uint16_t pix = 0;
+  uint16_t len = encodeLiveLeds(buf, sizeof(buf), pix, strip.size(), nullptr, false, readStrip);
+  const uint8_t expected[] = { 0xC1, 0,0,1, 0,0,2,  0x82, 0,0,3,  0xC0, 0,0,4 };
+  TEST_ASSERT_EQUAL_UINT16(sizeof(expected), len);
+  TEST_ASSERT_EQUAL_MEMORY(expected, buf, sizeof(expected));
+}
+
+// with the previous colors only changes are sent, unchanged pixels cost one byte per 128
+void test_delta_stream() {
+  for (uint8_t rgbw = 0; rgbw < 2; rgbw++) {
+    strip.resize(1500);
+    for (uint32_t& c : strip) c = randomColor(rgbw);
+    std::vector<uint32_t> prev(strip.size(), 0), client;
+    stream(client, prev.data(), rgbw, true, 1024);
+    TEST_ASSERT_TRUE(client == strip);
+    TEST_ASSERT_TRUE(prev == strip);
+
+    uint32_t sent = stream(client, prev.data(), rgbw, false, 1024);
+    TEST_ASSERT_EQUAL_UINT32(LIVE_LEDS_HEADER_LEN + (1500 + 127) / 128, sent);
+
+    for (uint16_t frame = 0; frame < 30; frame++) {
+      for (uint16_t k = 0; k < 50; k++) strip[rand() % strip.size()] = randomColor(rgbw);
+      for (uint16_t i = frame * 40; i < frame * 40 + 30; i++) strip[i] = 0x00FF0000; // a moving block
+      sent = stream(client, prev.data(), rgbw, false, (frame & 1) ? 1024 : 100);
+      TEST_ASSERT_TRUE(client == strip);
+      TEST_ASSERT_TRUE(sent < 1500 * 3 / 4);
+    }
+  }
+}
+
+// an empty strip is one empty message
+void test_empty() {
+  strip.clear();
+  uint8_t buf[16];
+  uint16_t pix = 0;
+  TEST_ASSERT_EQUAL_UINT16(0, encodeLiveLeds(buf, sizeof(buf), pix, 0, nullptr, true, readStrip));
+  TEST_ASSERT_EQUAL_UINT32(0, reads);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_header);
+  RUN_TEST(test_full_frame_round_trip);
+  RUN_TEST(test_repeat_records);
+  RUN_TEST(test_literal_to_repeat);
+  RUN_TEST(test_delta_stream);
+  RUN_TEST(test_empty);
+  return UNITY_END();
+}
@@ -0,0 +1,131 @@
+/*
+ * Host tests for the realtime packet ring (E131PacketRing), run with `pio test -e native`
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+
+#include "src/dependencies/e131/E131PacketRing.cpp"
+
+// packet contents are derived from a sequence number so the consumer can check every byte
+static uint16_t packetLen(uint32_t seq) { return 1 + (seq * 97) % 700; }
+static uint8_t  packetByte(uint32_t seq, uint16_t i) { return (uint8_t)(seq * 31 + i); }
+
+static uint16_t makePacket(uint8_t* buf, uint32_t seq) {
+  uint16_t len = packetLen(seq);
+  for (uint16_t i = 0; i < len; i++) buf[i] = packetByte(seq, i);
+  if (len >= 4) memcpy(buf, &seq, 4);
+  return len;
+}
+
+static bool checkPacket(const uint8_t* data, uint16_t len, uint32_t seq) {
+  if (len != packetLen(seq)) return false;
+  for (uint16_t i = (len >= 4) ? 4 : 0; i < len; i++) if (data[i] != packetByte(seq, i)) return false;
+  if (len >= 4) { uint32_t s; memcpy(&s, data, 4); if (s != seq) return false; }
+  return true;
+}
+
+void test_empty_until_begin() {
+  E131PacketRing ring;
+  uint16_t len; uint32_t ip; uint8_t protocol;
+  TEST_ASSERT_FALSE(ring.isActive());
+  TEST_ASSERT_NULL(ring.front(len, ip, protocol));
+  TEST_ASSERT_TRUE(ring.begin(1024));
+  TEST_ASSERT_TRUE(ring.isActive());
+  TEST_ASSERT_NULL(ring.front(len, ip, protocol));
+  ring.end();
+  TEST_ASSERT_FALSE(ring.isActive());
+  TEST_ASSERT_NULL(ring.front(len, ip, protocol));
+}
+
+void test_fifo_order_and_metadata() {
+  E131PacketRing ring;
+  TEST_ASSERT_TRUE(ring.begin(4096));
+  uint8_t buf[800];
+  for (uint32_t seq = 0; seq < 4; seq++) {
+    uint16_t len = makePacket(buf, seq);
+    TEST_ASSERT_TRUE(ring.push(buf, len, 0x0A000000 + seq, seq & 3));
+  }
+  for (uint32_t seq = 0; seq < 4; seq++) {
+    uint16_t len; uint32_t ip; uint8_t protocol;
+    const uint8_t* data = ring.front(len, ip, protocol);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_TRUE(checkPacket(data, len, seq));
+    TEST_ASSERT_EQUAL_UINT32(0x0A000000 + seq, ip);
+    TEST_ASSERT_EQUAL_UINT8(seq & 3, protocol);
+    ring.pop();
+  }
+  uint16_t len; uint32_t ip; uint8_t protocol;
+  TEST_ASSERT_NULL(ring.front(len, ip, protocol));
+  TEST_ASSERT_EQUAL_UINT32(0, ring.dropped());
+}
+
+void test_full_ring_drops() {
+  E131PacketRing ring;
+  TEST_ASSERT_TRUE(ring.begin(1040)); // two 512 byte entries and a bit
+  uint8_t buf[500] = {0};
+  TEST_ASSERT_TRUE(ring.push(buf, 500, 1, 0));
+  TEST_ASSERT_TRUE(ring.push(buf, 500, 2, 0));
+  TEST_ASSERT_FALSE(ring.push(buf, 500, 3, 0)); // head may not catch up with tail
+  TEST_ASSERT_EQUAL_UINT32(1, ring.dropped());
+
+  uint16_t len; uint32_t ip; uint8_t protocol;
+  TEST_ASSERT_NOT_NULL(ring.front(len, ip, protocol));
+  TEST_ASSERT_EQUAL_UINT32(1, ip);
+  ring.pop();
+  TEST_ASSERT_TRUE(ring.push(buf, 400, 4, 0)); // wraps to the start
+  TEST_ASSERT_NOT_NULL(ring.front(len, ip, protocol));
+  TEST_ASSERT_EQUAL_UINT32(2, ip);
+  ring.pop();
+  TEST_ASSERT_NOT_NULL(ring.front(len, ip, protocol));
+  TEST_ASSERT_EQUAL_UINT32(4, ip);
+  TEST_ASSERT_EQUAL_UINT16(400, len);
+  ring.pop();
+  TEST_ASSERT_NULL(ring.front(len, ip, protocol));
+}
+
+// one producer thread and one consumer thread, as the UDP task and the main loop use it
+void test_spsc_stress() {
+  const uint32_t packets = 200000;
+  E131PacketRing ring;
+  TEST_ASSERT_TRUE(ring.begin(8192));
+
+  std::atomic<bool> done{false};
+  std::thread producer([&]() {
+    uint8_t buf[800];
+    for (uint32_t seq = 0; seq < packets; seq++) {
+      uint16_t len = makePacket(buf, seq);
+      while (!ring.push(buf, len, seq, seq & 0xFF)) std::this_thread::yield(); // retry, so every packet arrives
+    }
+    done.store(true);
+  });
+
+  uint32_t expected = 0;
+  bool ok = true;
+  while (ok && expected < packets) {
+    uint16_t len; uint32_t ip; uint8_t protocol;
+    const uint8_t* data = ring.front(len, ip, protocol);
+    if (!data) { std::this_thread::yield(); continue; }
+    ok = checkPacket(data, len, expected) && ip == expected && protocol == (expected & 0xFF);
+    ring.pop();
+    expected++;
+  }
+  producer.join();
+
+  TEST_ASSERT_TRUE_MESSAGE(ok, "packet corrupted or out of order");
+  TEST_ASSERT_EQUAL_UINT32(packets, expected);
+  TEST_ASSERT_TRUE(done.load());
+  uint16_t len; uint32_t ip; uint8_t protocol;
+  TEST_ASSERT_NULL(ring.front(len, ip, protocol));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_until_begin);
+  RUN_TEST(test_fifo_order_and_metadata);
+  RUN_TEST(test_full_ring_drops);
+  RUN_TEST(test_spsc_stress);
+  return UNITY_END();
+}
@@ -0,0 +1,235 @@
+/*
+ * Host tests for the DDP, E1.31 and Art-Net senders (realtime_out.cpp), run with `pio test -e native`
+ * The packets go through a localhost UDP socket and are checked field by field as a receiver sees them.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "realtime_out.cpp"
+
+static int txSocket = -1, rxSocket = -1;
+static sockaddr_in rxAddr;
+static uint16_t sentUniverses[512];
+static uint16_t sentCount = 0;
+
+static bool udpSend(const uint8_t* packet, uint16_t len, uint16_t universe)
+{
+  if (sentCount < sizeof(sentUniverses) / sizeof(sentUniverses[0])) sentUniverses[sentCount] = universe;
+  sentCount++;
+  return sendto(txSocket, packet, len, 0, (const sockaddr*)&rxAddr, sizeof(rxAddr)) == len;
+}
+
+// next datagram at the receiver, -1 if none arrived
+static int udpReceive(uint8_t* buf, size_t size)
+{
+  return recv(rxSocket, buf, size, 0);
+}
+
+static uint16_t u16be(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+static uint16_t u16le(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+static uint8_t  packet[REALTIME_OUT_PACKET_SIZE];
+static uint8_t  rx[2048];
+static uint8_t  pixels[2000 * 4];
+static E131Source source;
+
+static void fillPixels() { for (uint32_t i = 0; i < sizeof(pixels); i++) pixels[i] = (uint8_t)(i * 7 + 3); }
+
+void setUp() {
+  sentCount = 0;
+  fillPixels();
+  for (uint8_t i = 0; i < 16; i++) source.cid[i] = 0xC0 + i;
+  source.name = "WLED test";
+}
+
+void tearDown() {
+  uint8_t tmp[16];
+  while (udpReceive(tmp, sizeof(tmp)) >= 0) ; // drain leftovers of a failed test
+}
+
+static void checkE131Header(const uint8_t* p, int len, uint16_t universe, uint16_t channels, uint8_t seq, uint16_t sync)
+{
+  static const uint8_t acnId[12] = { 'A','S','C','-','E','1','.','1','7',0,0,0 };
+  TEST_ASSERT_EQUAL_INT(E131_OUT_HEADER_LEN + channels, len);
+  TEST_ASSERT_EQUAL_UINT16(0x0010, u16be(p + E131_ROOT_PREAMBLE_SIZE));
+  TEST_ASSERT_EQUAL_UINT16(0, u16be(p + E131_ROOT_POSTAMBLE_SIZE));
+  TEST_ASSERT_EQUAL_MEMORY(acnId, p + E131_ROOT_ID, 12);
+  // flags and length of each layer cover the rest of the packet
+  TEST_ASSERT_EQUAL_HEX16(0x7000 | (len - E131_ROOT_FLENGTH), u16be(p + E131_ROOT_FLENGTH));
+  TEST_ASSERT_EQUAL_HEX16(0x7000 | (len - E131_FRAME_FLENGTH), u16be(p + E131_FRAME_FLENGTH));
+  TEST_ASSERT_EQUAL_HEX16(0x7000 | (len - E131_DMP_FLENGTH), u16be(p + E131_DMP_FLENGTH));
+  TEST_ASSERT_EQUAL_HEX32(0x00000004, (uint32_t)u16be(p + E131_ROOT_VECTOR) << 16 | u16be(p + E131_ROOT_VECTOR + 2));
+  TEST_ASSERT_EQUAL_MEMORY(source.cid, p + E131_ROOT_CID, 16);
+  TEST_ASSERT_EQUAL_HEX32(0x00000002, (uint32_t)u16be(p + E131_FRAME_VECTOR) << 16 | u16be(p + E131_FRAME_VECTOR + 2));
+  TEST_ASSERT_EQUAL_STRING("WLED test", (const char*)p + E131_FRAME_SOURCE);
+  TEST_ASSERT_EQUAL_UINT8(100, p[E131_FRAME_PRIORITY]);
+  TEST_ASSERT_EQUAL_UINT16(sync, u16be(p + E131_FRAME_RESERVED));
+  TEST_ASSERT_EQUAL_UINT8(seq, p[E131_FRAME_SEQ]);
+  TEST_ASSERT_EQUAL_UINT8(0, p[E131_FRAME_OPT]);
+  TEST_ASSERT_EQUAL_UINT16(universe, u16be(p + E131_FRAME_UNIVERSE));
+  TEST_ASSERT_EQUAL_HEX8(0x02, p[E131_DMP_VECTOR]);
+  TEST_ASSERT_EQUAL_HEX8(0xa1, p[E131_DMP_TYPE]);
+  TEST_ASSERT_EQUAL_UINT16(0, u16be(p + E131_DMP_ADDR_FIRST));
+  TEST_ASSERT_EQUAL_UINT16(1, u16be(p + E131_DMP_ADDR_INC));
+  TEST_ASSERT_EQUAL_UINT16(channels + 1, u16be(p + E131_DMP_COUNT));
+  TEST_ASSERT_EQUAL_UINT8(0, p[E131_DMP_DATA]);
+}
+
+// 600 RGB pixels at full brightness: universes of 170 pixels from 1 on, then a sync packet
+void test_e131_rgb_frame() {
+  uint8_t seq = 0;
+  TEST_ASSERT_TRUE(realtimeSendFrame(packet, udpSend, REALTIME_OUT_E131, pixels, 600, false, 255, 0, seq, source, 63999));
+  TEST_ASSERT_EQUAL_UINT8(1, seq);
+  TEST_ASSERT_EQUAL_UINT16(5, sentCount);
+
+  uint32_t channel = 0;
+  for (uint16_t u = 1; u <= 4; u++) {
+    uint16_t channels = (u < 4) ? 510 : (600 - 3 * 170) * 3;
+    int len = udpReceive(rx, sizeof(rx));
+    checkE131Header(rx, len, u, channels, 1, 63999);
+    TEST_ASSERT_EQUAL_MEMORY(pixels + channel, rx + E131_DMP_DATA + 1, channels);
+    channel += channels;
+  }
+
+  int len = udpReceive(rx, sizeof(rx));
+  TEST_ASSERT_EQUAL_INT(E131_SYNC_PACKET_LEN, len);
+  TEST_ASSERT_EQUAL_HEX16(0x7000 | (len - E131_ROOT_FLENGTH), u16be(rx + E131_ROOT_FLENGTH));
+  TEST_ASSERT_EQUAL_UINT8(0x08, rx[E131_ROOT_VECTOR + 3]);
+  TEST_ASSERT_EQUAL_MEMORY(source.cid, rx + E131_ROOT_CID, 16);
+  TEST_ASSERT_EQUAL_HEX16(0x7000 | (len - E131_FRAME_FLENGTH), u16be(rx + E131_FRAME_FLENGTH));
+  TEST_ASSERT_EQUAL_UINT8(0x01, rx[E131_FRAME_VECTOR + 3]);
+  TEST_ASSERT_EQUAL_UINT8(1, rx[44]);                 // sequence
+  TEST_ASSERT_EQUAL_UINT16(63999, u16be(rx + 45));    // sync universe
+  TEST_ASSERT_EQUAL_UINT16(63999, sentUniverses[4]);  // multicast group of the sync packet
+  TEST_ASSERT_TRUE(udpReceive(rx, sizeof(rx)) < 0);
+}
+
+// RGBW pixels keep whole pixels per universe and brightness is applied, no sync packet without a sync universe
+void test_e131_rgbw_start_universe_and_bri() {
+  uint8_t seq = 255;
+  TEST_ASSERT_TRUE(realtimeSendFrame(packet, udpSend, REALTIME_OUT_E131, pixels, 200, true, 127, 7, seq, source, 0));
+  TEST_ASSERT_EQUAL_UINT8(1, seq);                    // 0 is skipped
+  TEST_ASSERT_EQUAL_UINT16(2, sentCount);
+  TEST_ASSERT_EQUAL_UINT16(7, sentUniverses[0]);
+  TEST_ASSERT_EQUAL_UINT16(8, sentUniverses[1]);
+
+  int len = udpReceive(rx, sizeof(rx));
+  checkE131Header(rx, len, 7, 128 * 4, 1, 0);
+  for (uint16_t i = 0; i < 128 * 4; i++) TEST_ASSERT_EQUAL_UINT8((pixels[i] * 128) >> 8, rx[E131_DMP_DATA + 1 + i]);
+  len = udpReceive(rx, sizeof(rx));
+  checkE131Header(rx, len, 8, 72 * 4, 1, 0);
+  TEST_ASSERT_EQUAL_UINT8((pixels[128 * 4] * 128) >> 8, rx[E131_DMP_DATA + 1]);
+  TEST_ASSERT_TRUE(udpReceive(rx, sizeof(rx)) < 0);
+}
+
+// the last universe is not exceeded and a start universe past it sends nothing
+void test_e131_universe_limit() {
+  uint8_t seq = 0;
+  TEST_ASSERT_TRUE(realtimeSendFrame(packet, udpSend, REALTIME_OUT_E131, pixels, 600, false, 255, 63998, seq, source, 0));
+  TEST_ASSERT_EQUAL_UINT16(2, sentCount);
+  TEST_ASSERT_EQUAL_UINT16(63999, sentUniverses[1]);
+  sentCount = 0;
+  TEST_ASSERT_FALSE(realtimeSendFrame(packet, udpSend, REALTIME_OUT_E131, pixels, 600, false, 255, 64000, seq, source, 0));
+  TEST_ASSERT_FALSE(realtimeSendFrame(packet, udpSend, REALTIME_OUT_ARTNET, pixels, 600, false, 255, 0x8000, seq, source, 0));
+  TEST_ASSERT_EQUAL_UINT16(0, sentCount);
+}
+
+// Art-Net starts at port address 0, pads odd lengths and uses little endian universes
+void test_artnet_frame() {
+  uint8_t seq = 41;
+  TEST_ASSERT_TRUE(realtimeSendFrame(packet, udpSend, REALTIME_OUT_ARTNET, pixels, 171, false, 255, 0x1FF, seq, source, 63999));
+  TEST_ASSERT_EQUAL_UINT16(3, sentCount);
+
+  int len = udpReceive(rx, sizeof(rx));
+  TEST_ASSERT_EQUAL_INT(ARTNET_OUT_HEADER_LEN + 510, len);
+  TEST_ASSERT_EQUAL_STRING("Art-Net", (const char*)rx);
+  TEST_ASSERT_EQUAL_HEX16(ARTNET_OPCODE_OPDMX, u16le(rx + 8));
+  TEST_ASSERT_EQUAL_UINT16(14, u16be(rx + 10));
+  TEST_ASSERT_EQUAL_UINT8(42, rx[12]);
+  TEST_ASSERT_EQUAL_UINT8(0, rx[13]);
+  TEST_ASSERT_EQUAL_HEX16(0x1FF, u16le(rx + 14));
+  TEST_ASSERT_EQUAL_UINT16(510, u16be(rx + 16));
+  TEST_ASSERT_EQUAL_MEMORY(pixels, rx + ARTNET_OUT_HEADER_LEN, 510);
+
+  len = udpReceive(rx, sizeof(rx));
+  TEST_ASSERT_EQUAL_INT(ARTNET_OUT_HEADER_LEN + 4, len); // 3 channels padded to 4
+  TEST_ASSERT_EQUAL_HEX16(0x200, u16le(rx + 14));
+  TEST_ASSERT_EQUAL_UINT16(4, u16be(rx + 16));
+  TEST_ASSERT_EQUAL_MEMORY(pixels + 510, rx + ARTNET_OUT_HEADER_LEN, 3);
+  TEST_ASSERT_EQUAL_UINT8(0, rx[ARTNET_OUT_HEADER_LEN + 3]);
+
+  len = udpReceive(rx, sizeof(rx));
+  TEST_ASSERT_EQUAL_INT(ARTNET_SYNC_PACKET_LEN, len);
+  TEST_ASSERT_EQUAL_STRING("Art-Net", (const char*)rx);
+  TEST_ASSERT_EQUAL_HEX16(ARTNET_OPCODE_OPSYNC, u16le(rx + 8));
+  TEST_ASSERT_EQUAL_UINT16(14, u16be(rx + 10));
+  TEST_ASSERT_TRUE(udpReceive(rx, sizeof(rx)) < 0);
+}
+
+// DDP packets carry whole pixels at increasing offsets, sequence 1-15 and push on the last packet only
+void test_ddp_frame() {
+  uint8_t seq = 14;
+  TEST_ASSERT_TRUE(realtimeSendFrame(packet, udpSend, REALTIME_OUT_DDP, pixels, 1000, true, 255, 12, seq, source, 63999));
+  TEST_ASSERT_EQUAL_UINT16(3, sentCount);             // 360 RGBW pixels per packet, no sync packet
+  TEST_ASSERT_EQUAL_UINT8(2, seq);
+
+  const uint8_t seqs[3] = { 15, 1, 2 };
+  uint32_t offset = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    uint16_t channels = (i < 2) ? 1440 : (1000 - 720) * 4;
+    int len = udpReceive(rx, sizeof(rx));
+    TEST_ASSERT_EQUAL_INT(DDP_HEADER_LEN + channels, len);
+    TEST_ASSERT_EQUAL_HEX8(i < 2 ? DDP_FLAGS_VER1 : (DDP_FLAGS_VER1 | DDP_PUSH_FLAG), rx[0]);
+    TEST_ASSERT_EQUAL_UINT8(seqs[i], rx[1]);
+    TEST_ASSERT_EQUAL_HEX8(DDP_TYPE_RGBW32, rx[2]);
+    TEST_ASSERT_EQUAL_UINT8(DDP_ID_DISPLAY, rx[3]);
+    TEST_ASSERT_EQUAL_UINT32(12 + offset, (uint32_t)u16be(rx + 4) << 16 | u16be(rx + 6));
+    TEST_ASSERT_EQUAL_UINT16(channels, u16be(rx + 8));
+    TEST_ASSERT_EQUAL_MEMORY(pixels + offset, rx + DDP_HEADER_LEN, channels);
+    offset += channels;
+  }
+  TEST_ASSERT_TRUE(udpReceive(rx, sizeof(rx)) < 0);
+}
+
+// a failed send stops the frame
+static bool failSecond(const uint8_t*, uint16_t, uint16_t) { return ++sentCount < 2; }
+
+void test_send_failure() {
+  uint8_t seq = 0;
+  TEST_ASSERT_FALSE(realtimeSendFrame(packet, failSecond, REALTIME_OUT_ARTNET, pixels, 600, false, 255, 0, seq, source, 1));
+  TEST_ASSERT_EQUAL_UINT16(2, sentCount);
+}
+
+int main() {
+  txSocket = socket(AF_INET, SOCK_DGRAM, 0);
+  rxSocket = socket(AF_INET, SOCK_DGRAM, 0);
+  memset(&rxAddr, 0, sizeof(rxAddr));
+  rxAddr.sin_family = AF_INET;
+  rxAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  rxAddr.sin_port = 0; // any free port
+  bind(rxSocket, (const sockaddr*)&rxAddr, sizeof(rxAddr));
+  socklen_t addrLen = sizeof(rxAddr);
+  getsockname(rxSocket, (sockaddr*)&rxAddr, &addrLen);
+  int rcvBuf = 1 << 20;
+  setsockopt(rxSocket, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+  timeval timeout = { 0, 200000 };
+  setsockopt(rxSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  UNITY_BEGIN();
+  RUN_TEST(test_e131_rgb_frame);
+  RUN_TEST(test_e131_rgbw_start_universe_and_bri);
+  RUN_TEST(test_e131_universe_limit);
+  RUN_TEST(test_artnet_frame);
+  RUN_TEST(test_ddp_frame);
+  RUN_TEST(test_send_failure);
+  int failures = UNITY_END();
+  close(txSocket);
+  close(rxSocket);
+  return failures;
+}
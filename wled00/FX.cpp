@@ -1162,7 +1162,7 @@ uint16_t WS2812FX::mode_fireworks() {
 
   for(uint16_t i=0; i<MAX(1, SEGLEN/20); i++) {
     if(random8(129 - (SEGMENT.intensity >> 1)) == 0) {
-      uint16_t index = random(SEGLEN);
+      uint16_t index = random16(SEGLEN);
       setPixelColor(index, color_from_palette(random8(), false, false, 0));
       SEGENV.aux1 = SEGENV.aux0;
       SEGENV.aux0 = index;
@@ -1621,7 +1621,7 @@ uint16_t WS2812FX::mode_multi_comet(void)
       }
       comets[i]++;
     } else {
-      if(!random(SEGLEN)) {
+      if(!random16(SEGLEN)) {
         comets[i] = 0;
       }
     }
@@ -1892,41 +1892,60 @@ uint16_t WS2812FX::mode_palette()
 // in step 3 above) (Effect Intensity = Sparking).
 
 
+// heat values are capped at 240 before palette lookup, so 241 entries cover all of them
+#define FIRE_HEAT_LUT_SIZE 241
+// above this length it is cheaper to map each heat level once per frame than to look up every pixel
+#define FIRE_HEAT_LUT_MIN_LEN (2*FIRE_HEAT_LUT_SIZE)
+
 uint16_t WS2812FX::mode_fire_2012()
 {
   uint32_t it = now >> 5; //div 32
+  bool useLut = SEGLEN >= FIRE_HEAT_LUT_MIN_LEN;
+  uint16_t dataSize = SEGLEN + (useLut ? FIRE_HEAT_LUT_SIZE * sizeof(CRGB) : 0);
 
-  if (!SEGENV.allocateData(SEGLEN)) return mode_static(); //allocation failed
+  if (!SEGENV.allocateData(dataSize)) return mode_static(); //allocation failed
   
   byte* heat = SEGENV.data;
 
   if (it != SEGENV.step)
   {
-    uint8_t ignition = max(7,SEGLEN/10);  // ignition area: 10% of segment length or minimum 7 pixels
-    
+    uint16_t ignition = max(7,SEGLEN/10);  // ignition area: 10% of segment length or minimum 7 pixels
+    // cooling only depends on speed and segment length, so it is computed once per frame
+    uint8_t cooling = (((20 + SEGMENT.speed /3) * 10) / SEGLEN) + 2;
+
     // Step 1.  Cool down every cell a little
     for (uint16_t i = 0; i < SEGLEN; i++) {
-      uint8_t temp = qsub8(heat[i], random8(0, (((20 + SEGMENT.speed /3) * 10) / SEGLEN) + 2));
+      uint8_t temp = qsub8(heat[i], random8(cooling));
       heat[i] = (temp==0 && i<ignition) ? 16 : temp; // prevent ignition area from becoming black
     }
   
     // Step 2.  Heat from each cell drifts 'up' and diffuses a little
     for (uint16_t k= SEGLEN -1; k > 1; k--) {
-      heat[k] = (heat[k - 1] + (heat[k - 2]<<1) ) / 3;  // heat[k-2] multiplied by 2
+      // (a + 2b) / 3, the multiply-shift is exact for the whole 0-765 range
+      heat[k] = ((heat[k - 1] + (heat[k - 2]<<1)) * 683) >> 11;
     }
     
     // Step 3.  Randomly ignite new 'sparks' of heat near the bottom
     if (random8() <= SEGMENT.intensity) {
-      uint8_t y = random8(ignition);
+      uint8_t y = random8(MIN(ignition, 255));
       if (y < SEGLEN) heat[y] = qadd8(heat[y], random8(160,255));
     }
     SEGENV.step = it;
   }
 
   // Step 4.  Map from heat cells to LED colors
-  for (uint16_t j = 0; j < SEGLEN; j++) {
-    CRGB color = ColorFromPalette(currentPalette, MIN(heat[j],240), 255, LINEARBLEND);
-    setPixelColor(j, color.red, color.green, color.blue);
+  if (useLut) {
+    CRGB* lut = reinterpret_cast<CRGB*>(SEGENV.data + SEGLEN);
+    for (uint16_t h = 0; h < FIRE_HEAT_LUT_SIZE; h++) lut[h] = ColorFromPalette(currentPalette, h, 255, LINEARBLEND);
+    for (uint16_t j = 0; j < SEGLEN; j++) {
+      const CRGB &color = lut[MIN(heat[j],240)];
+      setPixelColor(j, color.red, color.green, color.blue);
+    }
+  } else {
+    for (uint16_t j = 0; j < SEGLEN; j++) {
+      CRGB color = ColorFromPalette(currentPalette, MIN(heat[j],240), 255, LINEARBLEND);
+      setPixelColor(j, color.red, color.green, color.blue);
+    }
   }
   return FRAMETIME;
 }
@@ -4143,15 +4162,15 @@ class AuroraWave {
 
   public:
     void init(uint32_t segment_length, CRGB color) {
-      ttl = random(500, 1501);
+      ttl = random16(500, 1501);
       basecolor = color;
-      basealpha = random(60, 101) / (float)100;
+      basealpha = random16(60, 101) / (float)100;
       age = 0;
-      width = random(segment_length / 20, segment_length / W_WIDTH_FACTOR); //half of width to make math easier
+      width = random16(segment_length / 20, segment_length / W_WIDTH_FACTOR); //half of width to make math easier
       if (!width) width = 1;
-      center = random(101) / (float)100 * segment_length;
-      goingleft = random(0, 2) == 0;
-      speed_factor = (random(10, 31) / (float)100 * W_MAX_SPEED / 255);
+      center = random16(101) / (float)100 * segment_length;
+      goingleft = random16(0, 2) == 0;
+      speed_factor = (random16(10, 31) / (float)100 * W_MAX_SPEED / 255);
       alive = true;
     }
 
@@ -4233,7 +4252,7 @@ uint16_t WS2812FX::mode_aurora(void) {
     waves = reinterpret_cast<AuroraWave*>(SEGENV.data);
 
     for(int i = 0; i < SEGENV.aux1; i++) {
-      waves[i].init(SEGLEN, col_to_crgb(color_from_palette(random8(), false, false, random(0, 3))));
+      waves[i].init(SEGLEN, col_to_crgb(color_from_palette(random8(), false, false, random16(0, 3))));
     }
   } else {
     waves = reinterpret_cast<AuroraWave*>(SEGENV.data);
@@ -4245,7 +4264,7 @@ uint16_t WS2812FX::mode_aurora(void) {
 
     if(!(waves[i].stillAlive())) {
       //If a wave dies, reinitialize it starts over.
-      waves[i].init(SEGLEN, col_to_crgb(color_from_palette(random8(), false, false, random(0, 3))));
+      waves[i].init(SEGLEN, col_to_crgb(color_from_palette(random8(), false, false, random16(0, 3))));
     }
   }
 
@@ -4271,4 +4290,77 @@ uint16_t WS2812FX::mode_aurora(void) {
   }
   
   return FRAMETIME;
-}
\ No newline at end of file
+}
+
+
+/*
+ * Effect metadata, indexed by mode ID.
+ * Data size is the worst case an effect allocates via allocateData() for a segment of SEGLEN pixels:
+ * dataFixed + dataPer8px * SEGLEN / 8 (rounded up). Keep it in sync when changing an allocation.
+ * Cost is the relative CPU time per pixel and frame, from 1 (solid fill) to 10.
+ */
+typedef struct EffectMeta {
+  uint16_t dataFixed;
+  uint8_t  dataPer8px;
+  uint8_t  cost;
+} effect_meta;
+
+static const effect_meta _modeMeta[MODE_COUNT] PROGMEM = {
+  {  0,  0, 1}, //FX_MODE_STATIC
+  {  0,  0, 1}, //FX_MODE_BLINK
+  {  0,  0, 1}, //FX_MODE_BREATH
+  {  0,  0, 1}, //FX_MODE_RANDOM_COLOR
+  {  0,  0, 1}, //FX_MODE_RAINBOW
+  {  0,  0, 2}, //FX_MODE_RAINBOW_CYCLE
+  {  0,  0, 1}, //FX_MODE_FADE
+  {  0,  0, 2}, //FX_MODE_RUNNING_LIGHTS
+  {  0,  0, 2}, //FX_MODE_SAW
+  {  0,  0, 3}, //FX_MODE_DISSOLVE
+  {  0,  0, 3}, //FX_MODE_DISSOLVE_RANDOM
+  {  0,  0, 2}, //FX_MODE_HYPER_SPARKLE
+  {  0,  0, 1}, //FX_MODE_STROBE
+  {  0,  0, 1}, //FX_MODE_STROBE_RAINBOW
+  {  0,  0, 1}, //FX_MODE_MULTI_STROBE
+  {  0,  0, 1}, //FX_MODE_BLINK_RAINBOW
+  {  0,  0, 3}, //FX_MODE_LARSON_SCANNER
+  {  0,  0, 4}, //FX_MODE_FIREWORKS
+  {  0,  0, 2}, //FX_MODE_FIRE_FLICKER
+  {sizeof(flasher), 8*sizeof(flasher), 4}, //FX_MODE_FAIRY, one flasher per pixel at full intensity
+  {  0, 8*sizeof(flasher), 4}, //FX_MODE_FAIRYTWINKLE
+  {  0,  0, 1}, //FX_MODE_TRICOLOR_WIPE
+  {  0,  0, 1}, //FX_MODE_TRICOLOR_FADE
+  {  0,  0, 1}, //FX_MODE_LIGHTNING
+  {  0,  0, 3}, //FX_MODE_DUAL_LARSON_SCANNER
+  {  0,  0, 4}, //FX_MODE_PRIDE_2015
+  {  0,  8, 5}, //FX_MODE_FIRE_2012, plus the heat LUT on long segments
+  {  0,  0, 4}, //FX_MODE_COLORWAVES
+  {  0,  0, 5}, //FX_MODE_FILLNOISE8
+  {  0,  1, 4}, //FX_MODE_COLORTWINKLE
+  {  0,  0, 4}, //FX_MODE_LAKE
+  {  0,  0, 6}, //FX_MODE_TWINKLEFOX
+  {  0,  0, 6}, //FX_MODE_TWINKLECAT
+  {  0,  0, 2}, //FX_MODE_CANDLE
+  {  0,  0, 3}, //FX_MODE_HEARTBEAT
+  {  0,  0, 8}, //FX_MODE_PACIFICA
+  {  0,  0, 2}, //FX_MODE_SUNRISE
+  {2*sizeof(CRGBPalette16), 0, 5}, //FX_MODE_NOISEPAL
+  {  0,  0, 3}, //FX_MODE_FLOW
+  {  0,  0, 1}, //FX_MODE_CANDY_CANE
+  {  0,  8, 2}  //FX_MODE_DYNAMIC_SMOOTH
+};
+
+uint16_t WS2812FX::getModeDataSize(uint8_t m, uint16_t len)
+{
+  if (m >= MODE_COUNT) return 0;
+  effect_meta meta;
+  memcpy_P(&meta, &_modeMeta[m], sizeof(effect_meta));
+  uint32_t size = meta.dataFixed + (((uint32_t)meta.dataPer8px * len) + 7) / 8;
+  if (m == FX_MODE_FIRE_2012 && len >= FIRE_HEAT_LUT_MIN_LEN) size += FIRE_HEAT_LUT_SIZE * sizeof(CRGB);
+  return MIN(size, UINT16_MAX);
+}
+
+uint8_t WS2812FX::getModeCost(uint8_t m)
+{
+  if (m >= MODE_COUNT) return 0;
+  return pgm_read_byte(&_modeMeta[m].cost);
+}
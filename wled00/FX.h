@@ -64,19 +64,32 @@
   #define MAX_NUM_TRANSITIONS  8
   /* How much data bytes all segments combined may allocate */
   #define MAX_SEGMENT_DATA  4096
+  /* How much previous frame buffer bytes (4 per virtual pixel) all segments combined may allocate */
+  #ifndef MAX_SEGMENT_PIXEL_DATA
+    #define MAX_SEGMENT_PIXEL_DATA 4096
+  #endif
 #else
   #ifndef MAX_NUM_SEGMENTS
     #define MAX_NUM_SEGMENTS  32
   #endif
   #define MAX_NUM_TRANSITIONS 24
   #define MAX_SEGMENT_DATA  20480
+  #ifndef MAX_SEGMENT_PIXEL_DATA
+    #define MAX_SEGMENT_PIXEL_DATA 32768
+  #endif
 #endif
 
 /* How much data bytes each segment should max allocate to leave enough space for other segments,
   assuming each segment uses the same amount of data. 256 for ESP8266, 640 for ESP32. */
 #define FAIR_DATA_PER_SEG (MAX_SEGMENT_DATA / MAX_NUM_SEGMENTS)
 
-#define MIN_SHOW_DELAY   (_frametime < 16 ? 8 : 15)
+//state of a segment data plan, see WS2812FX::startSegmentDataPlan()
+#define SEG_DATA_PLAN_NONE     0
+#define SEG_DATA_PLAN_OPEN     1
+#define SEG_DATA_PLAN_ACCEPTED 2
+#define SEG_DATA_PLAN_REJECTED 3
+
+#define MIN_SHOW_DELAY   (_frametime < 16 ? (_frametime < 8 ? 3 : 8) : 15)
 
 #define NUM_COLORS       3 /* number of colors per segment */
 #define SEGMENT          _segments[_segment_index]
@@ -269,13 +282,15 @@ class WS2812FX {
     } segment;
 
   // segment runtime parameters
-    typedef struct Segment_runtime { // 28 bytes
+    typedef struct Segment_runtime { // 36 bytes
       unsigned long next_time;  // millis() of next update
       uint32_t step;  // custom "step" var
       uint32_t call;  // call counter
       uint16_t aux0;  // custom var
       uint16_t aux1;  // custom var
+      uint16_t rand16seed; // random8/16 state of this segment, seeded on reset
       byte* data = nullptr;
+      uint32_t* pixels = nullptr; // unscaled RGBW output of the previous frame, one entry per virtual pixel
       bool allocateData(uint16_t len){
         if (data && _dataLen == len) return true; //already allocated
         deallocateData();
@@ -300,6 +315,39 @@ class WS2812FX {
         _dataLen = 0;
       }
 
+      /**
+       * Allocates the previous frame buffer that getPixelColor() reads from while the effect runs.
+       * Returns true only if a new buffer was allocated, so the caller can seed it.
+       * The buffer survives effect resets and is only reallocated if the virtual length changes.
+       */
+      bool allocatePixels(uint16_t len){
+        if (pixels && _pixelsLen == len) return false; //already allocated
+        deallocatePixels();
+        #ifndef WLED_DISABLE_SEGMENT_PIXELBUF
+        size_t bytes = len * sizeof(uint32_t);
+        if (!len || WS2812FX::instance->_usedSegmentPixelData + bytes > MAX_SEGMENT_PIXEL_DATA) return false; //not enough memory
+        #if defined(ARDUINO_ARCH_ESP32) && defined(WLED_USE_PSRAM)
+        if (psramFound())
+          pixels = (uint32_t*) ps_malloc(bytes);
+        else
+        #endif
+          pixels = (uint32_t*) malloc(bytes);
+        if (!pixels) return false; //allocation failed
+        WS2812FX::instance->_usedSegmentPixelData += bytes;
+        _pixelsLen = len;
+        return true;
+        #else
+        return false;
+        #endif
+      }
+      void deallocatePixels(){
+        free(pixels);
+        pixels = nullptr;
+        WS2812FX::instance->_usedSegmentPixelData -= _pixelsLen * sizeof(uint32_t);
+        _pixelsLen = 0;
+      }
+      inline uint16_t pixelsLength() { return _pixelsLen; }
+
       /** 
        * If reset of this segment was request, clears runtime
        * settings of this segment.
@@ -324,6 +372,7 @@ class WS2812FX {
       inline void markForReset() { _requiresReset = true; }
       private:
         uint16_t _dataLen = 0;
+        uint16_t _pixelsLen = 0;
         bool _requiresReset = false;
     } segment_runtime;
 
@@ -472,7 +521,6 @@ class WS2812FX {
       blur(uint8_t),
       fill(uint32_t),
       fade_out(uint8_t r),
-      setMode(uint8_t segid, uint8_t m),
       setColor(uint8_t slot, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0),
       setColor(uint8_t slot, uint32_t c),
       setCCT(uint16_t k),
@@ -490,20 +538,31 @@ class WS2812FX {
       makeAutoSegments(bool forceReset = false),
       fixInvalidSegments(),
       setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0),
-      show(void),
 			setTargetFps(uint8_t fps),
+      startSegmentDataPlan(),
+      planSegment(uint8_t n, uint8_t m, uint16_t len),
+      endSegmentDataPlan(),
       deserializeMap(uint8_t n=0);
 
     inline void setPixelColor(uint16_t n, uint32_t c) {setPixelColor(n, byte(c>>16), byte(c>>8), byte(c), byte(c>>24));}
+    // sets count consecutive live/realtime pixels starting at n
+    void setPixelColors(uint16_t n, const uint32_t* c, uint16_t count);
+
+    // hands the current frame to the busses without waiting for the wire, returns its token
+    uint32_t show(void);
 
     bool
       gammaCorrectBri = false,
       gammaCorrectCol = true,
       checkSegmentAlignment(void),
+      setMode(uint8_t segid, uint8_t m),
+      segmentDataFits(uint8_t n, uint8_t m),
+      acceptSegmentDataPlan(void),
       hasRGBWBus(void),
       hasCCTBus(void),
       // return true if the strip is being sent pixel updates
-      isUpdating(void);
+      isUpdating(void),
+      isFrameDone(uint32_t token);
 
     uint8_t
       paletteFade = 0,
@@ -513,6 +572,7 @@ class WS2812FX {
       cctBlending = 0,
       getBrightness(void),
       getModeCount(void),
+      getModeCost(uint8_t m),
       getPaletteCount(void),
       getMaxSegments(void),
       getActiveSegmentsNum(void),
@@ -525,6 +585,8 @@ class WS2812FX {
       gamma8_cal(uint8_t, float),
       get_random_wheel_index(uint8_t);
 
+    uint8_t* getGammaTable(void);
+
     inline uint8_t sin_gap(uint16_t in) {
       if (in & 0x100) return 0;
       return sin8(in + 192); // correct phase shift of sine so that it starts and stops at 0
@@ -539,6 +601,8 @@ class WS2812FX {
       triwave16(uint16_t),
       getLengthTotal(void),
       getLengthPhysical(void),
+      getModeDataSize(uint8_t m, uint16_t len),
+      getUsedSegmentData(void),
       getFps();
 
     uint32_t
@@ -693,6 +757,10 @@ class WS2812FX {
     uint16_t _rand16seed;
     uint8_t _brightness;
     uint16_t _usedSegmentData = 0;
+    uint8_t  _segmentDataPlan = SEG_DATA_PLAN_NONE; //effect changes planned for several segments at once, see startSegmentDataPlan()
+    uint8_t  _plannedModes[MAX_NUM_SEGMENTS];
+    uint16_t _plannedLens[MAX_NUM_SEGMENTS];
+    uint32_t _usedSegmentPixelData = 0;
     uint16_t _transitionDur = 750;
 
 		uint8_t _targetFps = 42;
@@ -730,6 +798,8 @@ class WS2812FX {
       spots_base(uint16_t),
       phased_base(uint8_t);
 
+    uint32_t getBusPixelColor(uint16_t);
+
     CRGB twinklefox_one_twinkle(uint32_t ms, uint8_t salt, bool cat);
     CRGB pacifica_one_layer(uint16_t i, CRGBPalette16& p, uint16_t cistart, uint16_t wavescale, uint8_t bri, uint16_t ioff);
 
@@ -745,6 +815,7 @@ class WS2812FX {
     
     uint32_t _lastPaletteChange = 0;
     uint32_t _lastShow = 0;
+    uint32_t _lastFrame = 0;
 
     uint32_t _colors_t[3];
     uint8_t _bri_t;
@@ -758,7 +829,7 @@ class WS2812FX {
       // start, stop, offset, speed, intensity, palette, mode, options, grouping, spacing, opacity (unused), color[], capabilities
       {0, 7, 0, DEFAULT_SPEED, 128, 0, DEFAULT_MODE, NO_OPTIONS, 1, 0, 255, {DEFAULT_COLOR}, 0}
     };
-    segment_runtime _segment_runtimes[MAX_NUM_SEGMENTS]; // SRAM footprint: 28 bytes per element
+    segment_runtime _segment_runtimes[MAX_NUM_SEGMENTS]; // SRAM footprint: 36 bytes per element
     friend class Segment_runtime;
 
     ColorTransition transitions[MAX_NUM_TRANSITIONS]; //12 bytes per element
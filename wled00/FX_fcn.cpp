@@ -76,6 +76,7 @@ void WS2812FX::finalizeInit(void)
   for (uint8_t i = 0; i < MAX_NUM_SEGMENTS; i++) {
     _segment_runtimes[i].markForReset();
     _segment_runtimes[i].resetIfRequired();
+    _segment_runtimes[i].deallocatePixels();
   }
 
   _hasWhiteChannel = _isOffRefreshRequired = false;
@@ -126,6 +127,7 @@ void WS2812FX::finalizeInit(void)
 void WS2812FX::service() {
   uint32_t nowUp = millis(); // Be aware, millis() rolls over every 49 days
   now = nowUp + timebase;
+  busses.service(); // send frames deferred by busy busses and collect finished transfers
   if (nowUp - _lastShow < MIN_SHOW_DELAY) return;
   bool doShow = false;
 
@@ -139,7 +141,10 @@ void WS2812FX::service() {
     // segment's buffers are cleared
     SEGENV.resetIfRequired();
 
-    if (!SEGMENT.isActive()) continue;
+    if (!SEGMENT.isActive()) {
+      if (SEGENV.pixels) SEGENV.deallocatePixels();
+      continue;
+    }
 
     // last condition ensures all solid segments are updated at the same time
     if(nowUp > SEGENV.next_time || _triggered || (doShow && SEGMENT.mode == 0))
@@ -150,6 +155,10 @@ void WS2812FX::service() {
 
       if (!SEGMENT.getOption(SEG_OPTION_FREEZE)) { //only run effect function if not frozen
         _virtualSegmentLength = SEGMENT.virtualLength();
+        if (SEGENV.allocatePixels(_virtualSegmentLength)) {
+          // seed a fresh previous frame buffer with what is currently on the strip
+          for (uint16_t p = 0; p < _virtualSegmentLength; p++) SEGENV.pixels[p] = getBusPixelColor(p);
+        }
         _bri_t = SEGMENT.opacity; _colors_t[0] = SEGMENT.colors[0]; _colors_t[1] = SEGMENT.colors[1]; _colors_t[2] = SEGMENT.colors[2];
         uint8_t _cct_t = SEGMENT.cct;
         if (!IS_SEGMENT_ON) _bri_t = 0;
@@ -170,7 +179,14 @@ void WS2812FX::service() {
         // If not RGB capable, also treat palette as if default (0), as palettes set white channel to 0
         _no_rgb = !(SEGMENT.getLightCapabilities() & 0x01);
         if (_no_rgb) Bus::setAutoWhiteMode(RGBW_MODE_MANUAL_ONLY);
+        // each segment draws from its own random stream so its output does not depend on other segments.
+        // The initial seed only depends on the segment config, so synced nodes produce the same sequence.
+        if (SEGENV.call == 0) SEGENV.rand16seed = ((i + 1) * 2053) ^ (SEGMENT.start << 3) ^ SEGMENT.mode;
+        uint16_t prevSeed = random16_get_seed();
+        random16_set_seed(SEGENV.rand16seed);
         delay = (this->*_mode[SEGMENT.mode])(); //effect function
+        SEGENV.rand16seed = random16_get_seed();
+        random16_set_seed(prevSeed);
         SEGENV.call++;
         Bus::setAutoWhiteMode(strip.autoWhiteMode);
       }
@@ -192,6 +208,8 @@ void IRAM_ATTR WS2812FX::setPixelColor(uint16_t i, byte r, byte g, byte b, byte
   uint8_t segIdx;
 
   if (SEGLEN) { // SEGLEN!=0 -> from segment/FX
+    // keep the unscaled color so the effect can read it back losslessly in the next frame
+    if (SEGENV.pixels && i < SEGENV.pixelsLength()) SEGENV.pixels[i] = RGBW32(r, g, b, w);
     //color_blend(getpixel, col, _bri_t); (pseudocode for future blending of segments)
     if (_bri_t < 255) {  
       r = scale8(r, _bri_t);
@@ -246,6 +264,18 @@ void IRAM_ATTR WS2812FX::setPixelColor(uint16_t i, byte r, byte g, byte b, byte
   }
 }
 
+void WS2812FX::setPixelColors(uint16_t i, const uint32_t* c, uint16_t count)
+{
+  // segment mapping (grouping, mirroring, offset) needs the per pixel path
+  if (SEGLEN || (realtimeMode && useMainSegmentOnly)) {
+    for (uint16_t j = 0; j < count; j++) setPixelColor(i + j, c[j]);
+    return;
+  }
+  // pixels covered by the ledmap are scattered, the rest is one contiguous range
+  for (; count && i < customMappingSize; i++, c++, count--) busses.setPixelColor(customMappingTable[i], *c);
+  if (count) busses.setPixelColors(i, c, count);
+}
+
 
 //DISCLAIMER
 //The following function attemps to calculate the current LED power usage,
@@ -330,32 +360,44 @@ void WS2812FX::estimateCurrentAndLimitBri() {
   currentMilliamps += pLen; //add standby power back to estimate
 }
 
-void WS2812FX::show(void) {
+uint32_t WS2812FX::show(void) {
 
   // avoid race condition, caputre _callback value
   show_callback callback = _callback;
   if (callback) callback();
 
   estimateCurrentAndLimitBri();
-  
+  #ifndef WLED_DISABLE_DITHERING
+  Bus::setDithering(_cumulativeFps >= WLED_DITHER_MIN_FPS); //below that, the alternating levels would be visible as flicker
+  #endif
+
   // some buses send asynchronously and this method will return before
-  // all of the data has been sent.
+  // all of the data has been sent. Busses still busy with the previous frame get this one once they are done.
   // See https://github.com/Makuna/NeoPixelBus/wiki/ESP32-NeoMethods#neoesp32rmt-methods
-  busses.show();
+  _lastFrame = busses.show();
   unsigned long now = millis();
   unsigned long diff = now - _lastShow;
   uint16_t fpsCurr = 200;
   if (diff > 0) fpsCurr = 1000 / diff;
   _cumulativeFps = (3 * _cumulativeFps + fpsCurr) >> 2;
   _lastShow = now;
+  return _lastFrame;
 }
 
 /**
- * Returns a true value if any of the strips are still being updated.
+ * Returns a true value if the last frame is not yet completely sent to all strips.
  * On some hardware (ESP32), strip updates are done asynchronously.
+ * Busses waiting for their own refresh rate do not count. Only queries, deferred frames are sent by service().
  */
 bool WS2812FX::isUpdating() {
-  return !busses.canAllShow();
+  return !busses.isFrameDone(_lastFrame);
+}
+
+/**
+ * Returns true once the frame with the given token (returned by show()) or a later one has been sent.
+ */
+bool WS2812FX::isFrameDone(uint32_t token) {
+  return busses.isFrameDone(token);
 }
 
 /**
@@ -372,7 +414,7 @@ uint8_t WS2812FX::getTargetFps() {
 }
 
 void WS2812FX::setTargetFps(uint8_t fps) {
-	if (fps > 0 && fps <= 120) _targetFps = fps;
+	if (fps > 0 && fps <= 250) _targetFps = fps; //above 120 mainly useful with per-bus refresh limits for the long busses
 	_frametime = 1000 / _targetFps;
 }
 
@@ -383,16 +425,27 @@ void WS2812FX::trigger() {
   _triggered = true;
 }
 
-void WS2812FX::setMode(uint8_t segid, uint8_t m) {
-  if (segid >= MAX_NUM_SEGMENTS) return;
+/*
+ * Sets effect m on segment segid. The change is rejected (returns false) if its declared data
+ * does not fit next to the other segments, unless it is part of an accepted segment data plan.
+ */
+bool WS2812FX::setMode(uint8_t segid, uint8_t m) {
+  if (segid >= MAX_NUM_SEGMENTS) return false;
    
   if (m >= MODE_COUNT) m = MODE_COUNT - 1;
 
   if (_segments[segid].mode != m) 
   {
+    uint16_t len = _segments[segid].virtualLength();
+    bool smaller = getModeDataSize(m, len) <= getModeDataSize(_segments[segid].mode, len);
+    if (!smaller) { //an effect that needs no more data than the current one is always allowed
+      if (_segmentDataPlan == SEG_DATA_PLAN_REJECTED) return false;
+      if (!(_segmentDataPlan == SEG_DATA_PLAN_ACCEPTED && _plannedModes[segid] == m) && !segmentDataFits(segid, m)) return false;
+    }
     _segment_runtimes[segid].markForReset();
     _segments[segid].mode = m;
   }
+  return true;
 }
 
 uint8_t WS2812FX::getModeCount()
@@ -400,6 +453,66 @@ uint8_t WS2812FX::getModeCount()
   return MODE_COUNT;
 }
 
+uint16_t WS2812FX::getUsedSegmentData(void)
+{
+  return _usedSegmentData;
+}
+
+/*
+ * Checks whether the effect data of all active segments still fits into MAX_SEGMENT_DATA
+ * if segment n ran effect m. Uses the worst case sizes declared in the effect metadata.
+ */
+bool WS2812FX::segmentDataFits(uint8_t n, uint8_t m)
+{
+  if (n >= MAX_NUM_SEGMENTS) return false;
+  uint32_t planned = 0;
+  for (uint8_t i = 0; i < MAX_NUM_SEGMENTS; i++)
+  {
+    if (!_segments[i].isActive() && i != n) continue;
+    planned += getModeDataSize((i == n) ? m : _segments[i].mode, _segments[i].virtualLength());
+  }
+  return planned <= MAX_SEGMENT_DATA;
+}
+
+/*
+ * Plans effect changes on several segments at once, so that whether they fit does not depend on
+ * the order they are applied in. Start from the current segments, planSegment() each segment that
+ * will change, then acceptSegmentDataPlan(). Until endSegmentDataPlan(), setMode() allows the
+ * planned effects if the plan fits and rejects all effect changes if it does not.
+ */
+void WS2812FX::startSegmentDataPlan()
+{
+  for (uint8_t i = 0; i < MAX_NUM_SEGMENTS; i++) {
+    _plannedModes[i] = _segments[i].mode;
+    _plannedLens[i]  = _segments[i].isActive() ? _segments[i].virtualLength() : 0;
+  }
+  _segmentDataPlan = SEG_DATA_PLAN_OPEN;
+}
+
+//len is the virtual length segment n will have, 0 if it will be inactive
+void WS2812FX::planSegment(uint8_t n, uint8_t m, uint16_t len)
+{
+  if (n >= MAX_NUM_SEGMENTS || _segmentDataPlan != SEG_DATA_PLAN_OPEN) return;
+  _plannedModes[n] = (m < MODE_COUNT) ? m : MODE_COUNT - 1;
+  _plannedLens[n]  = len;
+}
+
+bool WS2812FX::acceptSegmentDataPlan()
+{
+  if (_segmentDataPlan != SEG_DATA_PLAN_OPEN) return _segmentDataPlan == SEG_DATA_PLAN_ACCEPTED;
+  uint32_t planned = 0;
+  for (uint8_t i = 0; i < MAX_NUM_SEGMENTS; i++) {
+    if (_plannedLens[i]) planned += getModeDataSize(_plannedModes[i], _plannedLens[i]);
+  }
+  _segmentDataPlan = (planned <= MAX_SEGMENT_DATA) ? SEG_DATA_PLAN_ACCEPTED : SEG_DATA_PLAN_REJECTED;
+  return _segmentDataPlan == SEG_DATA_PLAN_ACCEPTED;
+}
+
+void WS2812FX::endSegmentDataPlan()
+{
+  _segmentDataPlan = SEG_DATA_PLAN_NONE;
+}
+
 uint8_t WS2812FX::getPaletteCount()
 {
   return 13 + GRADIENT_PALETTE_COUNT;
@@ -504,6 +617,13 @@ uint8_t WS2812FX::getActiveSegmentsNum(void) {
 }
 
 uint32_t WS2812FX::getPixelColor(uint16_t i)
+{
+  // effects read their own previous output from the segment buffer (unscaled, no bus round-trip)
+  if (SEGLEN && SEGENV.pixels && i < SEGENV.pixelsLength()) return SEGENV.pixels[i];
+  return getBusPixelColor(i);
+}
+
+uint32_t WS2812FX::getBusPixelColor(uint16_t i)
 {
   // get physical pixel
   i = i * SEGMENT.groupLength();;
@@ -1245,6 +1365,11 @@ uint8_t WS2812FX::gamma8(uint8_t b)
   return gammaT[b];
 }
 
+uint8_t* WS2812FX::getGammaTable()
+{
+  return gammaT;
+}
+
 uint32_t WS2812FX::gamma32(uint32_t color)
 {
   if (!gammaCorrectCol) return color;
@@ -1265,3 +1390,13 @@ WS2812FX* WS2812FX::instance = nullptr;
 int16_t Bus::_cct = -1;
 uint8_t Bus::_cctBlend = 0;
 uint8_t Bus::_autoWhiteMode = RGBW_MODE_DUAL;
+bool    Bus::_dither = false;
+bool    Bus::_ditherEnabled = false;
+
+//                                                          R   G   B
+const uint8_t BusDigital::colorOrderShifts[COL_ORDER_MAX+1][3] = {{16,  8,  0},  //0 = GRB, default
+                                                                  { 8, 16,  0},  //1 = RGB, common for WS2811
+                                                                  {16,  0,  8},  //2 = BRG
+                                                                  { 0, 16,  8},  //3 = RBG
+                                                                  { 8,  0, 16},  //4 = BGR
+                                                                  { 0,  8, 16}}; //5 = GBR
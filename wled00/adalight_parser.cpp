@@ -0,0 +1,82 @@
+#include "adalight_parser.h"
+
+/*
+ * Adalight and TPM2 serial framing
+ */
+
+uint8_t AdalightParser::feed(uint8_t next)
+{
+  switch (state) {
+    case Header_A:
+      if (next == 'A')       state = Header_d;
+      else if (next == 0xC9) state = TPM2_Header_Type; //TPM2 start byte
+      else return ADALIGHT_COMMAND;
+      break;
+    case Header_d:
+      if (next == 'd') state = Header_a;
+      else             state = Header_A;
+      break;
+    case Header_a:
+      if (next == 'a') state = Header_CountHi;
+      else             state = Header_A;
+      break;
+    case Header_CountHi:
+      pixel = 0;
+      count = next * 0x100;
+      check = next;
+      state = Header_CountLo;
+      break;
+    case Header_CountLo:
+      count += next + 1; //wraps to 0 for 65536 pixels, which are rejected below
+      check = check ^ next ^ 0x55;
+      state = Header_CountCheck;
+      break;
+    case Header_CountCheck:
+      if (check == next && count) state = Data_Red;
+      else                        state = Header_A;
+      break;
+    case TPM2_Header_Type:
+      state = Header_A; //(unsupported) TPM2 command or invalid type
+      if (next == 0xDA) state = TPM2_Header_CountHi; //TPM2 data
+      else if (next == 0xAA) return ADALIGHT_PING;
+      break;
+    case TPM2_Header_CountHi:
+      pixel = 0;
+      count = next * 0x100; //payload length in bytes
+      state = TPM2_Header_CountLo;
+      break;
+    case TPM2_Header_CountLo:
+      count = (count + next) /3;
+      state = count ? Data_Red : Header_A;
+      break;
+    case Data_Red:
+      red   = next;
+      state = Data_Green;
+      break;
+    case Data_Green:
+      green = next;
+      state = Data_Blue;
+      break;
+    case Data_Blue:
+      blue  = next;
+      pixel++;
+      if (--count > 0) {
+        state = Data_Red;
+        return ADALIGHT_PIXEL;
+      }
+      state = Header_A;
+      return ADALIGHT_FRAME;
+  }
+  return ADALIGHT_NONE;
+}
+
+bool AdalightParser::bulkRead(uint16_t n)
+{
+  if (state != Data_Red) return false;
+  if (n > count) n = count;
+  pixel += n;
+  count -= n;
+  if (count) return false;
+  state = Header_A;
+  return true;
+}
@@ -0,0 +1,59 @@
+#ifndef AdalightParser_h
+#define AdalightParser_h
+
+/*
+ * Adalight and TPM2 serial framing, without Serial or strip dependencies (host tested, see test/)
+ * wled_serial.cpp feeds it the received bytes and acts on the returned events.
+ */
+
+#include <stdint.h>
+
+#define ADALIGHT_NONE    0 // byte consumed
+#define ADALIGHT_COMMAND 1 // byte outside of a frame that does not start one, a WLED serial command
+#define ADALIGHT_PIXEL   2 // pixel complete, see pixelIndex() and red/green/blue
+#define ADALIGHT_FRAME   3 // pixel complete and it was the last one of the frame
+#define ADALIGHT_PING    4 // TPM2 ping, answer with 0xAC
+
+class AdalightParser {
+  public:
+    AdalightParser() : red(0), green(0), blue(0), state(Header_A), count(0), pixel(0), check(0) {}
+
+    // handles one byte and returns one of the events above
+    uint8_t feed(uint8_t next);
+
+    // whole pixels that may be copied in bulk instead of fed byte by byte, 0 outside of pixel data
+    uint16_t bulkPixels() const { return (state == Data_Red) ? count : 0; }
+    // index the next pixel of the frame goes to
+    uint16_t nextPixel() const { return pixel; }
+    // n (at most bulkPixels()) pixels were copied in bulk, returns true if that completed the frame
+    bool bulkRead(uint16_t n);
+
+    // index of the pixel completed by the last ADALIGHT_PIXEL or ADALIGHT_FRAME event
+    uint16_t pixelIndex() const { return pixel - 1; }
+    bool idle() const { return state == Header_A; }
+
+    uint8_t red, green, blue;
+
+  private:
+    enum State : uint8_t {
+      Header_A,
+      Header_d,
+      Header_a,
+      Header_CountHi,
+      Header_CountLo,
+      Header_CountCheck,
+      Data_Red,
+      Data_Green,
+      Data_Blue,
+      TPM2_Header_Type,
+      TPM2_Header_CountHi,
+      TPM2_Header_CountLo,
+    };
+
+    State state;
+    uint16_t count;   // pixels left in the frame
+    uint16_t pixel;
+    uint8_t check;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef BusColor_h
+#define BusColor_h
+
+/*
+ * Color and brightness math of the bus drivers, without hardware dependencies (host tested, see test/)
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+//scales all four channels of a color by brightness b (255 keeps the color)
+inline uint32_t scaleBri(uint32_t c, uint8_t b) {
+  uint32_t f = uint32_t(b) + 1;
+  return (((c & 0x00FF00FF) * f >> 8) & 0x00FF00FF) | (((c >> 8) & 0x00FF00FF) * f & 0xFF00FF00);
+}
+
+//scaleBri() for a span of n channel bytes, four at a time (src and dst may be unaligned)
+inline void scaleBriSpan(uint8_t* dst, const uint8_t* src, uint16_t n, uint8_t b) {
+  uint16_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    uint32_t c;
+    memcpy(&c, src + i, 4);
+    c = scaleBri(c, b);
+    memcpy(dst + i, &c, 4);
+  }
+  for (; i < n; i++) dst[i] = (uint16_t(src[i]) * (uint16_t(b) + 1)) >> 8;
+}
+
+#ifndef WLED_DISABLE_DITHERING
+//scaleBri() with temporal dithering: the fraction lost by each channel is kept in res[4] and carried into the next frame
+//brightness 0 is off: black without carry, and the residuals are cleared so nothing flashes when turned on again
+inline uint32_t scaleBriDither(uint32_t c, uint8_t b, uint8_t* res) {
+  if (!b) {
+    res[0] = res[1] = res[2] = res[3] = 0;
+    return 0;
+  }
+  uint16_t f = uint16_t(b) + 1;
+  uint32_t out = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    uint16_t v = uint8_t(c >> (i*8)) * f + res[i];
+    res[i] = v & 0xFF;
+    out |= uint32_t(v >> 8) << (i*8);
+  }
+  return out;
+}
+#endif
+
+/*
+ * Splits brightness b applied to r, g and b into the 5 bit global brightness of an APA102 and 8 bit colors (returned in r, g, b).
+ * The global brightness is the lowest level that can still show the brightest channel,
+ * so dim pixels keep close to 8 bits of color resolution instead of being scaled down to a few steps.
+ * Pixels that scaleBri() would turn black, like all pixels at brightness 0, are sent black with global brightness 0.
+ */
+inline uint8_t apa102Split(uint8_t &r, uint8_t &g, uint8_t &b, uint8_t bri) {
+  //7936/gb (rounded): scales a 16 bit intensity to 8 bit at global brightness gb, in 1/65536 units
+  static const uint16_t k[32] = {0, 7936, 3968, 2645, 1984, 1587, 1323, 1134, 992, 882, 794, 721, 661, 610, 567, 529,
+                                 496, 467, 441, 418, 397, 378, 361, 345, 331, 317, 305, 294, 283, 274, 265, 256};
+  uint32_t f = uint32_t(bri) + 1;
+  uint32_t tr = r * f, tg = g * f, tb = b * f; //16 bit intensities, 65280 is full
+  uint32_t tmax = tr > tg ? tr : tg;
+  if (tb > tmax) tmax = tb;
+  if (tmax < 256) { r = g = b = 0; return 0; } //off, as scaleBri() would give (brightness 0 included)
+  uint8_t gb = (tmax * 31 + 65279) / 65280;
+  uint32_t v;
+  v = (tr * k[gb] + 32768) >> 16; r = v > 255 ? 255 : v;
+  v = (tg * k[gb] + 32768) >> 16; g = v > 255 ? 255 : v;
+  v = (tb * k[gb] + 32768) >> 16; b = v > 255 ? 255 : v;
+  return gb;
+}
+
+//reorders the R, G and B bytes of a WLED color into wire order, sh are the shifts of the color order (see BusDigital::colorOrderShifts)
+inline uint32_t toWireOrder(uint32_t c, const uint8_t* sh) {
+  return (c & 0xFF000000) | (uint32_t(uint8_t(c >> sh[0])) << 16) | (uint32_t(uint8_t(c >> sh[1])) << 8) | uint8_t(c >> sh[2]);
+}
+
+#endif
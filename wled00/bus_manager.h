@@ -48,11 +48,13 @@ struct BusConfig {
   bool reversed;
   uint8_t skipAmount;
   bool refreshReq;
+  uint8_t targetFps; //refresh rate limit of the bus, 0 = every frame
+  uint32_t startChannel; //network busses: first channel at the receiver (DDP) or first universe (E1.31/Art-Net)
   uint8_t pins[5] = {LEDPIN, 255, 255, 255, 255};
-  BusConfig(uint8_t busType, uint8_t* ppins, uint16_t pstart, uint16_t len = 1, uint8_t pcolorOrder = COL_ORDER_GRB, bool rev = false, uint8_t skip = 0) {
+  BusConfig(uint8_t busType, uint8_t* ppins, uint16_t pstart, uint16_t len = 1, uint8_t pcolorOrder = COL_ORDER_GRB, bool rev = false, uint8_t skip = 0, uint8_t fps = 0, uint32_t startCh = 0) {
     refreshReq = (bool) GET_BIT(busType,7);
     type = busType & 0x7F;  // bit 7 may be/is hacked to include refresh info (1=refresh in off state, 0=no refresh)
-    count = len; start = pstart; colorOrder = pcolorOrder; reversed = rev; skipAmount = skip;
+    count = len; start = pstart; colorOrder = pcolorOrder; reversed = rev; skipAmount = skip; targetFps = fps; startChannel = startCh;
     uint8_t nPins = 1;
     if (type >= TYPE_NET_DDP_RGB && type < 96) nPins = 4; //virtual network bus. 4 "pins" store IP address
     else if (type > 47) nPins = 2;
@@ -129,6 +131,14 @@ struct ColorOrderMap {
   ColorOrderMapEntry _mappings[WLED_MAX_COLOR_ORDER_MAPPINGS];
 };
 
+// A range of bus pixels sharing one color order, as resolved from the ColorOrderMap for a single bus.
+struct ColorOrderRun {
+  uint16_t start; // first pixel of the run (bus internal index, including skipped pixels)
+  uint8_t colorOrder;
+};
+// worst case: every mapping starts and ends inside the bus, plus the override range
+#define MAX_COLOR_ORDER_RUNS (WLED_MAX_COLOR_ORDER_MAPPINGS*2 +3)
+
 //parent class of BusDigital, BusPwm, and BusNetwork
 class Bus {
   public:
@@ -143,7 +153,13 @@ class Bus {
     virtual bool     canShow() { return true; }
 		virtual void     setStatusPixel(uint32_t c) {}
     virtual void     setPixelColor(uint16_t pix, uint32_t c) {}
+    virtual void     setPixelColors(uint16_t pix, const uint32_t* c, uint16_t count) {
+      for (uint16_t i = 0; i < count; i++) setPixelColor(pix + i, c[i]);
+    }
     virtual uint32_t getPixelColor(uint16_t pix) { return 0; }
+    virtual void     getPixelColors(uint16_t pix, uint32_t* c, uint16_t count) {
+      for (uint16_t i = 0; i < count; i++) c[i] = getPixelColor(pix + i);
+    }
     virtual void     setBrightness(uint8_t b) {}
     virtual void     cleanup() {}
     virtual uint8_t  getPins(uint8_t* pinArray) { return 0; }
@@ -151,17 +167,24 @@ class Bus {
     virtual void     setColorOrder() {}
     virtual uint8_t  getColorOrder() { return COL_ORDER_RGB; }
     virtual uint8_t  skippedLeds() { return 0; }
+    virtual uint32_t getStartChannel() { return 0; }
     inline  uint16_t getStart() { return _start; }
     inline  void     setStart(uint16_t start) { _start = start; }
     inline  uint8_t  getType() { return _type; }
     inline  bool     isOk() { return _valid; }
     inline  bool     isOffRefreshRequired() { return _needsRefresh; }
+    inline  void     setTargetFps(uint8_t fps) { _fps = fps; _frameTime = fps ? 1000 / fps : 0; }
+    inline  uint8_t  getTargetFps() { return _fps; }
+    //true if the own refresh rate of the bus allows showing a frame at millis() now
+    inline  bool     isDue(uint32_t now) { return !_frameTime || now - _lastShowAt >= _frameTime; }
+    inline  void     setShown(uint32_t now) { _lastShowAt = now; }
             bool     containsPixel(uint16_t pix) { return pix >= _start && pix < _start+_len; }
 
     virtual bool isRgbw() { return Bus::isRgbw(_type); }
     static  bool isRgbw(uint8_t type) {
       if (type == TYPE_SK6812_RGBW || type == TYPE_TM1814) return true;
       if (type > TYPE_ONOFF && type <= TYPE_ANALOG_5CH && type != TYPE_ANALOG_3CH) return true;
+      if (type >= TYPE_NET_DDP_RGBW && type <= TYPE_NET_ARTNET_RGBW) return true;
       return false;
     }
     static void setCCT(uint16_t cct) {
@@ -176,6 +199,15 @@ class Bus {
 			#endif
 		}
 		inline static void    setAutoWhiteMode(uint8_t m) { if (m < 4) _autoWhiteMode = m; }
+		inline static void    setDithering(bool d) { _dither = d && _ditherEnabled; }
+		//dithering is opt-in as it needs the pixel buffer and remainders, takes effect for busses created afterwards
+		inline static void    setDitherEnabled(bool e) {
+			#ifndef WLED_DISABLE_DITHERING
+			_ditherEnabled = e;
+			#endif
+			if (!_ditherEnabled) _dither = false;
+		}
+		inline static bool    isDitherEnabled() { return _ditherEnabled; }
 		inline static uint8_t getAutoWhiteMode() { return _autoWhiteMode; }
 
     bool reversed = false;
@@ -187,7 +219,12 @@ class Bus {
     uint16_t _len = 1;
     bool     _valid = false;
     bool     _needsRefresh = false;
+    uint8_t  _fps = 0;
+    uint16_t _frameTime = 0;  //ms between frames, 0 = no limit
+    uint32_t _lastShowAt = 0;
     static uint8_t _autoWhiteMode;
+    static bool    _dither;
+    static bool    _ditherEnabled;
     static int16_t _cct;
 		static uint8_t _cctBlend;
   
@@ -208,7 +245,7 @@ class Bus {
 
 class BusDigital : public Bus {
   public:
-  BusDigital(BusConfig &bc, uint8_t nr, const ColorOrderMap &com) : Bus(bc.type, bc.start), _colorOrderMap(com) {
+  BusDigital(BusConfig &bc, uint8_t nr, const ColorOrderMap &com, bool useBuffer = false) : Bus(bc.type, bc.start), _colorOrderMap(com) {
     if (!IS_DIGITAL(bc.type) || !bc.count) return;
     if (!pinManager.allocatePin(bc.pins[0], true, PinOwner::BusDigital)) return;
     _pins[0] = bc.pins[0];
@@ -224,58 +261,123 @@ class BusDigital : public Bus {
     _len = bc.count + _skip;
     _iType = PolyBus::getI(bc.type, _pins, nr);
     if (_iType == I_NONE) return;
-    _busPtr = PolyBus::create(_iType, _pins, _len, nr);
-    _valid = (_busPtr != nullptr);
+    _driver = PolyBus::create(_iType, _pins, _len, nr);
+    _valid = (_driver != nullptr);
+    // optional WLED side copy of the pixels in output order, without brightness applied. Without it pixels go straight into the driver
+    if (_valid && useBuffer) _data = (uint32_t*)calloc(_len, sizeof(uint32_t));
     _colorOrder = bc.colorOrder;
+    updateColorOrder();
     DEBUG_PRINTF("Successfully inited strip %u (len %u) with type %u and pins %u,%u (itype %u)\n",nr, _len, bc.type, _pins[0],_pins[1],_iType);
   };
 
-  inline void show() {
-    PolyBus::show(_busPtr, _iType);
+  void show() {
+    if (!_valid) return;
+    if (_data) { //hand the buffer to the driver, one color order run at a time
+      for (uint8_t r = 0; r < _numOrderRuns; r++) {
+        uint16_t first = _orderRuns[r].start;
+        uint16_t last  = (r + 1 < _numOrderRuns) ? _orderRuns[r+1].start : _len;
+        _driver->encode(_data + first, first, last - first, colorOrderShifts[_orderRuns[r].colorOrder], _dither);
+      }
+    }
+    _driver->show();
   }
 
   inline bool canShow() {
-    return PolyBus::canShow(_busPtr, _iType);
+    return !_valid || _driver->canShow();
   }
 
   void setBrightness(uint8_t b) {
+    if (!_valid) return;
     //Fix for turning off onboard LED breaking bus
     #ifdef LED_BUILTIN
     if (_bri == 0 && b > 0) {
-      if (_pins[0] == LED_BUILTIN || _pins[1] == LED_BUILTIN) PolyBus::begin(_busPtr, _iType, _pins); 
+      if (_pins[0] == LED_BUILTIN || _pins[1] == LED_BUILTIN) _driver->begin(_pins);
     }
     #endif
     _bri = b;
-    PolyBus::setBrightness(_busPtr, _iType, b);
+    _driver->setBrightness(b);
   }
 
 	//If LEDs are skipped, it is possible to use the first as a status LED.
 	//TODO only show if no new show due in the next 50ms
 	void setStatusPixel(uint32_t c) {
-    if (_skip && canShow()) {
-      PolyBus::setPixelColor(_busPtr, _iType, 0, c, _colorOrderMap.getPixelColorOrder(_start, _colorOrder));
-      PolyBus::show(_busPtr, _iType);
+    if (_valid && _skip && canShow()) {
+      if (_data) _data[0] = c;
+      else _driver->setPixelColor(0, toWireOrder(c, orderShiftsAt(0)));
+      show();
     }
   }
 
   void setPixelColor(uint16_t pix, uint32_t c) {
+    if (!_valid) return;
     if (_type == TYPE_SK6812_RGBW || _type == TYPE_TM1814) c = autoWhiteCalc(c);
     if (_cct >= 1900) c = colorBalanceFromKelvin(_cct, c); //color correction from CCT
     if (reversed) pix = _len - pix -1;
     else pix += _skip;
-    PolyBus::setPixelColor(_busPtr, _iType, pix, c, _colorOrderMap.getPixelColorOrder(pix+_start, _colorOrder));
+    if (_data) _data[pix] = c;
+    else _driver->setPixelColor(pix, toWireOrder(c, orderShiftsAt(pix)));
+  }
+
+  //bulk write of count pixels starting at pix, applies the color order once per run instead of per pixel
+  void setPixelColors(uint16_t pix, const uint32_t* c, uint16_t count) {
+    if (!_valid) return;
+    if (pix >= getLength()) return;
+    if (count > getLength() - pix) count = getLength() - pix;
+    bool aw = (_type == TYPE_SK6812_RGBW || _type == TYPE_TM1814);
+    if (_data) { //color order is applied when the buffer is encoded
+      for (uint16_t i = 0; i < count; i++) {
+        uint32_t col = c[i];
+        if (aw) col = autoWhiteCalc(col);
+        if (_cct >= 1900) col = colorBalanceFromKelvin(_cct, col); //color correction from CCT
+        _data[reversed ? _len - pix - i -1 : pix + _skip + i] = col;
+      }
+      return;
+    }
+    while (count) {
+      uint16_t dpix = reversed ? _len - pix -1 : pix + _skip;
+      uint8_t r = orderRunAt(dpix);
+      // pixels left in this run, walking in the direction the bus is written
+      uint16_t n;
+      if (reversed) n = dpix - _orderRuns[r].start + 1;
+      else          n = ((r + 1 < _numOrderRuns) ? _orderRuns[r+1].start : _len) - dpix;
+      if (n > count) n = count;
+      const uint8_t* sh = colorOrderShifts[_orderRuns[r].colorOrder];
+      for (uint16_t i = 0; i < n; i++) {
+        uint32_t col = c[i];
+        if (aw) col = autoWhiteCalc(col);
+        if (_cct >= 1900) col = colorBalanceFromKelvin(_cct, col); //color correction from CCT
+        _driver->setPixelColor(reversed ? dpix - i : dpix + i, toWireOrder(col, sh));
+      }
+      pix += n; c += n; count -= n;
+    }
   }
 
   uint32_t getPixelColor(uint16_t pix) {
+    if (!_valid) return 0;
     if (reversed) pix = _len - pix -1;
     else pix += _skip;
-    return PolyBus::getPixelColor(_busPtr, _iType, pix, _colorOrderMap.getPixelColorOrder(pix+_start, _colorOrder));
+    if (_data) return _data[pix];
+    return fromWireOrder(_driver->getPixelColor(pix), orderShiftsAt(pix));
+  }
+
+  //bulk read of count pixels starting at pix, a plain copy when the bus has a pixel buffer
+  void getPixelColors(uint16_t pix, uint32_t* c, uint16_t count) {
+    if (!_valid) return;
+    if (pix >= getLength()) return;
+    if (count > getLength() - pix) count = getLength() - pix;
+    if (!_data) { Bus::getPixelColors(pix, c, count); return; }
+    if (!reversed) { memcpy(c, _data + pix + _skip, count * sizeof(uint32_t)); return; }
+    for (uint16_t i = 0; i < count; i++) c[i] = _data[_len - pix - i -1];
   }
 
   inline uint8_t getColorOrder() {
     return _colorOrder;
   }
 
+  inline bool hasPixelBuffer() {
+    return _data != nullptr;
+  }
+
   uint16_t getLength() {
     return _len - _skip;
   }
@@ -289,6 +391,49 @@ class BusDigital : public Bus {
   void setColorOrder(uint8_t colorOrder) {
     if (colorOrder > 5) return;
     _colorOrder = colorOrder;
+    updateColorOrder();
+  }
+
+  /*
+   * Resolves the ColorOrderMap (and COLOR_ORDER_OVERRIDE) for this bus into sorted, non-overlapping runs of equal color order,
+   * so per-pixel lookups are a search over a few runs and buffers are encoded with one swizzle per run.
+   * Must be called whenever the color order map changes.
+   */
+  void updateColorOrder() {
+    uint16_t bounds[MAX_COLOR_ORDER_RUNS];
+    uint8_t nb = 0;
+    bounds[nb++] = 0;
+    #ifdef COLOR_ORDER_OVERRIDE
+    if (COO_MIN > 0 && COO_MIN < _len) bounds[nb++] = COO_MIN;
+    if (COO_MAX > 0 && COO_MAX < _len) bounds[nb++] = COO_MAX;
+    #endif
+    for (uint8_t i = 0; i < _colorOrderMap.count(); i++) {
+      const ColorOrderMapEntry* e = _colorOrderMap.get(i);
+      int32_t first = int32_t(e->start) - _start;
+      int32_t last  = first + e->len;
+      if (first > 0 && first < _len) bounds[nb++] = first;
+      if (last  > 0 && last  < _len) bounds[nb++] = last;
+    }
+    //insertion sort, there are only a handful of boundaries
+    for (uint8_t i = 1; i < nb; i++) {
+      uint16_t b = bounds[i];
+      uint8_t j = i;
+      for (; j > 0 && bounds[j-1] > b; j--) bounds[j] = bounds[j-1];
+      bounds[j] = b;
+    }
+    ColorOrderRun runs[MAX_COLOR_ORDER_RUNS];
+    uint8_t nr = 0;
+    for (uint8_t i = 0; i < nb; i++) {
+      if (i > 0 && bounds[i] == bounds[i-1]) continue;
+      uint8_t co = colorOrderAt(bounds[i]);
+      if (nr > 0 && runs[nr-1].colorOrder == co) continue; //merge with previous run
+      runs[nr].start = bounds[i];
+      runs[nr].colorOrder = co;
+      nr++;
+    }
+    // copy before publishing the count so a concurrent reader never sees an empty table
+    memcpy(_orderRuns, runs, nr * sizeof(ColorOrderRun));
+    _numOrderRuns = nr;
   }
 
   inline uint8_t skippedLeds() {
@@ -296,15 +441,17 @@ class BusDigital : public Bus {
   }
 
   inline void reinit() {
-    PolyBus::begin(_busPtr, _iType, _pins);
+    if (_valid) _driver->begin(_pins);
   }
 
   void cleanup() {
     DEBUG_PRINTLN(F("Digital Cleanup."));
-    PolyBus::cleanup(_busPtr, _iType);
+    delete _driver;
+    _driver = nullptr;
+    free(_data);
+    _data = nullptr;
     _iType = I_NONE;
     _valid = false;
-    _busPtr = nullptr;
     pinManager.deallocatePin(_pins[1], PinOwner::BusDigital);
     pinManager.deallocatePin(_pins[0], PinOwner::BusDigital);
   }
@@ -313,13 +460,46 @@ class BusDigital : public Bus {
     cleanup();
   }
 
+  //bit positions of the WLED R, G and B bytes that go into the R, G and B slot of the driver, per COL_ORDER_*
+  static const uint8_t colorOrderShifts[COL_ORDER_MAX+1][3];
+
   private: 
   uint8_t _colorOrder = COL_ORDER_GRB;
   uint8_t _pins[2] = {255, 255};
   uint8_t _iType = I_NONE;
   uint8_t _skip = 0;
-  void * _busPtr = nullptr;
+  uint8_t _numOrderRuns = 1;
+  ColorOrderRun _orderRuns[MAX_COLOR_ORDER_RUNS] = {{0, COL_ORDER_GRB}};
+  PolyDriver* _driver = nullptr;
+  uint32_t* _data = nullptr;
   const ColorOrderMap &_colorOrderMap;
+
+  //index of the color order run containing pixel pix (driver space)
+  inline uint8_t orderRunAt(uint16_t pix) {
+    uint8_t lo = 0, hi = _numOrderRuns -1;
+    while (lo < hi) {
+      uint8_t mid = (lo + hi + 1) >> 1;
+      if (_orderRuns[mid].start <= pix) lo = mid;
+      else hi = mid -1;
+    }
+    return lo;
+  }
+
+  inline const uint8_t* orderShiftsAt(uint16_t pix) {
+    return colorOrderShifts[_orderRuns[(_numOrderRuns > 1) ? orderRunAt(pix) : 0].colorOrder];
+  }
+
+  //color order of a pixel (driver space) from the override and the color order map, only used to build the runs
+  uint8_t colorOrderAt(uint16_t pix) {
+    #ifdef COLOR_ORDER_OVERRIDE
+    if (pix >= COO_MIN && pix < COO_MAX) return COO_ORDER;
+    #endif
+    return _colorOrderMap.getPixelColorOrder(pix + _start, _colorOrder);
+  }
+
+  static inline uint32_t fromWireOrder(uint32_t c, const uint8_t* sh) {
+    return (c & 0xFF000000) | (uint32_t(R(c)) << sh[0]) | (uint32_t(G(c)) << sh[1]) | (uint32_t(B(c)) << sh[2]);
+  }
 };
 
 
@@ -481,31 +661,15 @@ class BusNetwork : public Bus {
   public:
     BusNetwork(BusConfig &bc) : Bus(bc.type, bc.start) {
       _valid = false;
-//      switch (bc.type) {
-//        case TYPE_NET_ARTNET_RGB:
-//          _rgbw = false;
-//          _UDPtype = 2;
-//          break;
-//        case TYPE_NET_E131_RGB:
-//          _rgbw = false;
-//          _UDPtype = 1;
-//          break;
-//        case TYPE_NET_DDP_RGB:
-//          _rgbw = false;
-//          _UDPtype = 0;
-//          break;
-//        default:
-          _rgbw = false;
-          _UDPtype = bc.type - TYPE_NET_DDP_RGB;
-//          break;
-//      }
+      _rgbw = Bus::isRgbw(bc.type);
+      _UDPtype = bc.type - (_rgbw ? TYPE_NET_DDP_RGBW : TYPE_NET_DDP_RGB); // 0 DDP, 1 E1.31, 2 Art-Net
       _UDPchannels = _rgbw ? 4 : 3;
       _data = (byte *)malloc(bc.count * _UDPchannels);
       if (_data == nullptr) return;
       memset(_data, 0, bc.count * _UDPchannels);
       _len = bc.count;
       _client = IPAddress(bc.pins[0],bc.pins[1],bc.pins[2],bc.pins[3]);
-      _broadcastLock = false;
+      _startChannel = bc.startChannel;
       _valid = true;
     };
 
@@ -523,19 +687,13 @@ class BusNetwork : public Bus {
   uint32_t getPixelColor(uint16_t pix) {
     if (!_valid || pix >= _len) return 0;
     uint16_t offset = pix * _UDPchannels;
-    return RGBW32(_data[offset], _data[offset+1], _data[offset+2], _rgbw ? (_data[offset+3] << 24) : 0);
+    return RGBW32(_data[offset], _data[offset+1], _data[offset+2], _rgbw ? _data[offset+3] : 0);
   }
 
+  //the packets are sent before realtimeBroadcast() returns, so the bus is never busy
   void show() {
-    if (!_valid || !canShow()) return;
-    _broadcastLock = true;
-    realtimeBroadcast(_UDPtype, _client, _len, _data, _bri, _rgbw);
-    _broadcastLock = false;
-  }
-
-  inline bool canShow() {
-    // this should be a return value from UDP routine if it is still sending data out
-    return !_broadcastLock;
+    if (!_valid) return;
+    realtimeBroadcast(_UDPtype, _client, _len, _data, _bri, _rgbw, _startChannel);
   }
 
   inline void setBrightness(uint8_t b) {
@@ -557,6 +715,10 @@ class BusNetwork : public Bus {
     return _len;
   }
 
+  inline uint32_t getStartChannel() {
+    return _startChannel;
+  }
+
   void cleanup() {
     _type = I_NONE;
     _valid = false;
@@ -570,52 +732,68 @@ class BusNetwork : public Bus {
 
   private:
     IPAddress _client;
+    uint32_t  _startChannel;
     uint8_t   _bri = 255;
     uint8_t   _UDPtype;
     uint8_t   _UDPchannels;
     bool      _rgbw;
-    bool      _broadcastLock;
     byte     *_data;
 };
 
 
+#define DITHER_MEM(len) ((len)*4) //dithering remainders of NeoBusDriver
+
 class BusManager {
   public:
   BusManager() {
 
   };
 
-  //utility to get the approx. memory usage of a given BusConfig
+  /*
+   * utility to get the approx. memory usage of the driver of a given BusConfig
+   * This is the budget busses are admitted against (MAX_LED_MEMORY), it must not grow or existing setups would lose busses.
+   * So it stays at the long standing estimates even where a driver takes more (I2S DMA buffers, the DMA SPI frame).
+   * Optional extras like the pixel buffer are only added if they still fit, see add().
+   */
   static uint32_t memUsage(BusConfig &bc) {
     uint8_t type = bc.type;
     uint16_t len = bc.count + bc.skipAmount;
     if (type > 15 && type < 32) {
+      uint8_t channels = (type > 29) ? 4 : 3; //RGBW
       #ifdef ESP8266
-        if (bc.pins[0] == 3) { //8266 DMA uses 5x the mem
-          if (type > 29) return len*20; //RGBW
-          return len*15;
-        }
-        if (type > 29) return len*4; //RGBW
-        return len*3;
+        if (bc.pins[0] == 3) return len*channels*5; //8266 DMA uses 5x the mem
+        return len*channels;
       #else //ESP32 RMT uses double buffer?
-        if (type > 29) return len*8; //RGBW
-        return len*6;
+        return len*channels*2;
       #endif
     }
     if (type > 31 && type < 48)   return 5;
     if (type == 44 || type == 45) return len*4; //RGBW
+    if (IS_NETWORK(type) && Bus::isRgbw(type)) return len*4;
     return len*3; //RGB
   }
-  
+
+  //memory of the WLED side pixel copy of a digital bus, plus the dithering remainders if enabled
+  static inline uint32_t pixelBufferSize(BusConfig &bc) {
+    uint32_t len = bc.count + bc.skipAmount;
+    return len * sizeof(uint32_t) + (Bus::isDitherEnabled() ? DITHER_MEM(len) : 0);
+  }
+
   int add(BusConfig &bc) {
     if (numBusses >= WLED_MAX_BUSSES) return -1;
-    if (bc.type >= TYPE_NET_DDP_RGB && bc.type < 96) {
+    if (IS_NETWORK(bc.type)) {
       busses[numBusses] = new BusNetwork(bc);
     } else if (IS_DIGITAL(bc.type)) {
-      busses[numBusses] = new BusDigital(bc, numBusses, colorOrderMap);
+      // the pixel copy keeps colors unscaled for lossless readback and dithering, it is made if it still fits the LED memory budget
+      bool useBuffer = _memUsage + memUsage(bc) + pixelBufferSize(bc) <= MAX_LED_MEMORY;
+      BusDigital* bd = new BusDigital(bc, numBusses, colorOrderMap, useBuffer);
+      if (bd->hasPixelBuffer()) _memUsage += pixelBufferSize(bc);
+      busses[numBusses] = bd;
     } else {
       busses[numBusses] = new BusPwm(bc);
     }
+    busses[numBusses]->setTargetFps(bc.targetFps);
+    _memUsage += memUsage(bc);
     return numBusses++;
   }
 
@@ -626,12 +804,68 @@ class BusManager {
     while (!canAllShow()) yield();
     for (uint8_t i = 0; i < numBusses; i++) delete busses[i];
     numBusses = 0;
+    _memUsage = 0;
+    _sending = _deferred = _busy = 0;
+    _frameDone = _frame;
+  }
+
+  /*
+   * Starts sending the current frame and returns its token (never 0).
+   * Busses still transmitting the previous frame are not waited for, they get the frame from service() once ready.
+   * The same goes for busses whose own refresh rate does not allow another frame yet, so each bus runs on its own clock.
+   * A frame is done when no bus is transmitting it or waiting to do so, see isFrameDone().
+   * Busses only held back by their refresh rate do not count, they show whatever frame is current when they are due.
+   */
+  uint32_t show() {
+    if (++_frame == 0) _frame = 1;
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < numBusses; i++) {
+      uint32_t bit = 1UL << i;
+      bool ready = busses[i]->canShow();
+      if (ready && busses[i]->isDue(now)) {
+        _sending &= ~bit;
+        _deferred &= ~bit;
+        _busy &= ~bit;
+        busses[i]->setShown(now);
+        busses[i]->show();
+        if (!busses[i]->canShow()) _sending |= bit;
+      } else {
+        _deferred |= bit; //the bus keeps its pixels, so a later frame simply replaces this one
+        if (ready) _busy &= ~bit;
+        else       _busy |= bit;
+      }
+    }
+    if (!(_sending | _busy)) _frameDone = _frame;
+    return _frame;
   }
 
-  void show() {
+  //shows deferred frames on busses that became ready and notes finished transfers, call often
+  void service() {
+    if (!(_sending | _deferred)) return;
+    uint32_t now = millis();
     for (uint8_t i = 0; i < numBusses; i++) {
-      busses[i]->show();
+      uint32_t bit = 1UL << i;
+      if (!((_sending | _deferred) & bit) || !busses[i]->canShow()) continue;
+      _sending &= ~bit;
+      _busy &= ~bit;
+      if ((_deferred & bit) && busses[i]->isDue(now)) {
+        _deferred &= ~bit;
+        busses[i]->setShown(now);
+        busses[i]->show();
+        if (!busses[i]->canShow()) _sending |= bit;
+      }
     }
+    if (!(_sending | _busy)) _frameDone = _frame;
+  }
+
+  //true once the frame with this token (or a later one) is on all busses that are due, does not send anything itself
+  bool isFrameDone(uint32_t token) {
+    if ((int32_t)(_frameDone - token) >= 0) return true;
+    if (_busy || (int32_t)(_frame - token) < 0) return false; //deferred frames are only sent by service()
+    for (uint8_t i = 0; i < numBusses; i++) {
+      if ((_sending & (1UL << i)) && !busses[i]->canShow()) return false;
+    }
+    return true;
   }
 
 	void setStatusPixel(uint32_t c) {
@@ -649,6 +883,19 @@ class BusManager {
     }
   }
 
+  //sets count consecutive pixels starting at pix, split across the busses they belong to
+  void setPixelColors(uint16_t pix, const uint32_t* c, uint16_t count) {
+    for (uint8_t i = 0; i < numBusses; i++) {
+      Bus* b = busses[i];
+      uint16_t bstart = b->getStart();
+      uint16_t bend = bstart + b->getLength();
+      if (pix >= bend || pix + count <= bstart) continue;
+      uint16_t first = (pix > bstart) ? pix : bstart;
+      uint16_t last  = (pix + count < bend) ? pix + count : bend;
+      b->setPixelColors(first - bstart, c + (first - pix), last - first);
+    }
+  }
+
   void setBrightness(uint8_t b) {
     for (uint8_t i = 0; i < numBusses; i++) {
       busses[i]->setBrightness(b);
@@ -674,6 +921,20 @@ class BusManager {
     return 0;
   }
 
+  //reads count consecutive pixels starting at pix, pixels not on any bus read as black
+  void getPixelColors(uint16_t pix, uint32_t* c, uint16_t count) {
+    memset(c, 0, count * sizeof(uint32_t));
+    for (uint8_t i = 0; i < numBusses; i++) {
+      Bus* b = busses[i];
+      uint16_t bstart = b->getStart();
+      uint16_t bend = bstart + b->getLength();
+      if (pix >= bend || pix + count <= bstart) continue;
+      uint16_t first = (pix > bstart) ? pix : bstart;
+      uint16_t last  = (pix + count < bend) ? pix + count : bend;
+      b->getPixelColors(first - bstart, c + (first - pix), last - first);
+    }
+  }
+
   bool canAllShow() {
     for (uint8_t i = 0; i < numBusses; i++) {
       if (!busses[i]->canShow()) return false;
@@ -699,6 +960,10 @@ class BusManager {
 
   void updateColorOrderMap(const ColorOrderMap &com) {
     memcpy(&colorOrderMap, &com, sizeof(ColorOrderMap));
+    for (uint8_t i = 0; i < numBusses; i++) {
+      uint8_t type = busses[i]->getType();
+      if (IS_DIGITAL(type) && !IS_NETWORK(type)) static_cast<BusDigital*>(busses[i])->updateColorOrder();
+    }
   }
 
   const ColorOrderMap& getColorOrderMap() const {
@@ -707,6 +972,12 @@ class BusManager {
 
   private:
   uint8_t numBusses = 0;
+  uint32_t _memUsage = 0;
+  uint32_t _frame = 0;     //token of the last frame passed to show()
+  uint32_t _frameDone = 0; //token of the last frame that is completely sent
+  uint32_t _sending = 0;   //bitmask of busses still transmitting
+  uint32_t _deferred = 0;  //bitmask of busses that still have to show the last frame
+  uint32_t _busy = 0;      //deferred busses that were still transmitting, the frame is not done before they got it
   Bus* busses[WLED_MAX_BUSSES];
   ColorOrderMap colorOrderMap;
 };
@@ -1,7 +1,23 @@
 #ifndef BusWrapper_h
 #define BusWrapper_h
 
-#include "NeoPixelBrightnessBus.h"
+#include "NeoPixelBus.h"
+#include "bus_color.h"
+#ifdef ARDUINO_ARCH_ESP32
+  #include <driver/spi_master.h>
+  #include <esp_heap_caps.h>
+#endif
+
+//how a driver has to be started, see NeoBusDriver::begin()
+#define DRV_BEGIN_DEFAULT 0
+#define DRV_BEGIN_TM1814  1 //Begin() and per-pixel current settings
+#define DRV_BEGIN_SPI     2 //Begin() with explicit SPI pins (ESP32)
+
+#ifdef ARDUINO_ARCH_ESP32
+  #define DRV_BEGIN_HSPI DRV_BEGIN_SPI
+#else
+  #define DRV_BEGIN_HSPI DRV_BEGIN_DEFAULT
+#endif
 
 //Hardware SPI Pins
 #define P_8266_HS_MOSI 13
@@ -11,6 +27,23 @@
 #define P_32_VS_MOSI   23
 #define P_32_VS_CLK    18
 
+//ESP32 DMA SPI clock per chip type in kHz
+#ifndef WLED_SPI_KHZ_APA102
+  #define WLED_SPI_KHZ_APA102  5000
+#endif
+#ifndef WLED_SPI_KHZ_LPD8806
+  #define WLED_SPI_KHZ_LPD8806 10000
+#endif
+#ifndef WLED_SPI_KHZ_LPD6803
+  #define WLED_SPI_KHZ_LPD6803 5000
+#endif
+#ifndef WLED_SPI_KHZ_WS2801
+  #define WLED_SPI_KHZ_WS2801  2000
+#endif
+#ifndef WLED_SPI_KHZ_P9813
+  #define WLED_SPI_KHZ_P9813   5000
+#endif
+
 //The dirty list of possible bus types. Quite a lot...
 #define I_NONE 0
 //ESP8266 RGB
@@ -73,671 +106,521 @@
 #define I_HS_LPO_3 37
 #define I_SS_LPO_3 38
 
+//ESP32 I2S1 in parallel (LCD) mode, one lane per bus (WLED_USE_PARALLEL_I2S)
+#define I_32_PX_NEO_3 39
+#define I_32_PX_NEO_4 40
+#define I_32_PX_400_3 41
+#define I_32_PX_TM1_4 42
+
+//ESP32 DMA hardware SPI (SpiDmaDriver)
+#define I_32_DS_DOT_3 43
+#define I_32_DS_LPD_3 44
+#define I_32_DS_LPO_3 45
+#define I_32_DS_WS1_3 46
+#define I_32_DS_P98_3 47
+
 
 /*** ESP8266 Neopixel methods ***/
 #ifdef ESP8266
 //RGB
-#define B_8266_U0_NEO_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp8266Uart0Ws2813Method> //3 chan, esp8266, gpio1
-#define B_8266_U1_NEO_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp8266Uart1Ws2813Method> //3 chan, esp8266, gpio2
-#define B_8266_DM_NEO_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp8266Dma800KbpsMethod>  //3 chan, esp8266, gpio3
-#define B_8266_BB_NEO_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp8266BitBang800KbpsMethod> //3 chan, esp8266, bb (any pin but 16)
+#define B_8266_U0_NEO_3 NeoBusDriver<NeoGrbFeature, NeoEsp8266Uart0Ws2813Method> //3 chan, esp8266, gpio1
+#define B_8266_U1_NEO_3 NeoBusDriver<NeoGrbFeature, NeoEsp8266Uart1Ws2813Method> //3 chan, esp8266, gpio2
+#define B_8266_DM_NEO_3 NeoBusDriver<NeoGrbFeature, NeoEsp8266Dma800KbpsMethod>  //3 chan, esp8266, gpio3
+#define B_8266_BB_NEO_3 NeoBusDriver<NeoGrbFeature, NeoEsp8266BitBang800KbpsMethod> //3 chan, esp8266, bb (any pin but 16)
 //RGBW
-#define B_8266_U0_NEO_4 NeoPixelBrightnessBus<NeoGrbwFeature, NeoEsp8266Uart0Ws2813Method>   //4 chan, esp8266, gpio1
-#define B_8266_U1_NEO_4 NeoPixelBrightnessBus<NeoGrbwFeature, NeoEsp8266Uart1Ws2813Method>   //4 chan, esp8266, gpio2
-#define B_8266_DM_NEO_4 NeoPixelBrightnessBus<NeoGrbwFeature, NeoEsp8266Dma800KbpsMethod>    //4 chan, esp8266, gpio3
-#define B_8266_BB_NEO_4 NeoPixelBrightnessBus<NeoGrbwFeature, NeoEsp8266BitBang800KbpsMethod> //4 chan, esp8266, bb (any pin)
+#define B_8266_U0_NEO_4 NeoBusDriver<NeoGrbwFeature, NeoEsp8266Uart0Ws2813Method>   //4 chan, esp8266, gpio1
+#define B_8266_U1_NEO_4 NeoBusDriver<NeoGrbwFeature, NeoEsp8266Uart1Ws2813Method>   //4 chan, esp8266, gpio2
+#define B_8266_DM_NEO_4 NeoBusDriver<NeoGrbwFeature, NeoEsp8266Dma800KbpsMethod>    //4 chan, esp8266, gpio3
+#define B_8266_BB_NEO_4 NeoBusDriver<NeoGrbwFeature, NeoEsp8266BitBang800KbpsMethod> //4 chan, esp8266, bb (any pin)
 //400Kbps
-#define B_8266_U0_400_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp8266Uart0400KbpsMethod>   //3 chan, esp8266, gpio1
-#define B_8266_U1_400_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp8266Uart1400KbpsMethod>   //3 chan, esp8266, gpio2
-#define B_8266_DM_400_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp8266Dma400KbpsMethod>     //3 chan, esp8266, gpio3
-#define B_8266_BB_400_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp8266BitBang400KbpsMethod> //3 chan, esp8266, bb (any pin)
+#define B_8266_U0_400_3 NeoBusDriver<NeoGrbFeature, NeoEsp8266Uart0400KbpsMethod>   //3 chan, esp8266, gpio1
+#define B_8266_U1_400_3 NeoBusDriver<NeoGrbFeature, NeoEsp8266Uart1400KbpsMethod>   //3 chan, esp8266, gpio2
+#define B_8266_DM_400_3 NeoBusDriver<NeoGrbFeature, NeoEsp8266Dma400KbpsMethod>     //3 chan, esp8266, gpio3
+#define B_8266_BB_400_3 NeoBusDriver<NeoGrbFeature, NeoEsp8266BitBang400KbpsMethod> //3 chan, esp8266, bb (any pin)
 //TM1814 (RGBW)
-#define B_8266_U0_TM1_4 NeoPixelBrightnessBus<NeoWrgbTm1814Feature, NeoEsp8266Uart0Tm1814Method>
-#define B_8266_U1_TM1_4 NeoPixelBrightnessBus<NeoWrgbTm1814Feature, NeoEsp8266Uart1Tm1814Method>
-#define B_8266_DM_TM1_4 NeoPixelBrightnessBus<NeoWrgbTm1814Feature, NeoEsp8266DmaTm1814Method>
-#define B_8266_BB_TM1_4 NeoPixelBrightnessBus<NeoWrgbTm1814Feature, NeoEsp8266BitBangTm1814Method>
+#define B_8266_U0_TM1_4 NeoBusDriver<NeoWrgbTm1814Feature, NeoEsp8266Uart0Tm1814Method, DRV_BEGIN_TM1814>
+#define B_8266_U1_TM1_4 NeoBusDriver<NeoWrgbTm1814Feature, NeoEsp8266Uart1Tm1814Method, DRV_BEGIN_TM1814>
+#define B_8266_DM_TM1_4 NeoBusDriver<NeoWrgbTm1814Feature, NeoEsp8266DmaTm1814Method, DRV_BEGIN_TM1814>
+#define B_8266_BB_TM1_4 NeoBusDriver<NeoWrgbTm1814Feature, NeoEsp8266BitBangTm1814Method, DRV_BEGIN_TM1814>
 #endif
 
 /*** ESP32 Neopixel methods ***/
 #ifdef ARDUINO_ARCH_ESP32
 //RGB
-#define B_32_RN_NEO_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp32RmtNWs2812xMethod>
+#define B_32_RN_NEO_3 NeoBusDriver<NeoGrbFeature, NeoEsp32RmtNWs2812xMethod>
 #ifndef CONFIG_IDF_TARGET_ESP32C3
-#define B_32_I0_NEO_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp32I2s0800KbpsMethod>
+#define B_32_I0_NEO_3 NeoBusDriver<NeoGrbFeature, NeoEsp32I2s0800KbpsMethod>
 #endif
 #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-#define B_32_I1_NEO_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp32I2s1800KbpsMethod>
+#define B_32_I1_NEO_3 NeoBusDriver<NeoGrbFeature, NeoEsp32I2s1800KbpsMethod>
 #endif
 //RGBW
-#define B_32_RN_NEO_4 NeoPixelBrightnessBus<NeoGrbwFeature, NeoEsp32RmtNWs2812xMethod>
+#define B_32_RN_NEO_4 NeoBusDriver<NeoGrbwFeature, NeoEsp32RmtNWs2812xMethod>
 #ifndef CONFIG_IDF_TARGET_ESP32C3
-#define B_32_I0_NEO_4 NeoPixelBrightnessBus<NeoGrbwFeature, NeoEsp32I2s0800KbpsMethod>
+#define B_32_I0_NEO_4 NeoBusDriver<NeoGrbwFeature, NeoEsp32I2s0800KbpsMethod>
 #endif
 #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-#define B_32_I1_NEO_4 NeoPixelBrightnessBus<NeoGrbwFeature, NeoEsp32I2s1800KbpsMethod>
+#define B_32_I1_NEO_4 NeoBusDriver<NeoGrbwFeature, NeoEsp32I2s1800KbpsMethod>
 #endif
 //400Kbps
-#define B_32_RN_400_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp32RmtN400KbpsMethod>
+#define B_32_RN_400_3 NeoBusDriver<NeoGrbFeature, NeoEsp32RmtN400KbpsMethod>
 #ifndef CONFIG_IDF_TARGET_ESP32C3
-#define B_32_I0_400_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp32I2s0400KbpsMethod>
+#define B_32_I0_400_3 NeoBusDriver<NeoGrbFeature, NeoEsp32I2s0400KbpsMethod>
 #endif
 #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-#define B_32_I1_400_3 NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp32I2s1400KbpsMethod>
+#define B_32_I1_400_3 NeoBusDriver<NeoGrbFeature, NeoEsp32I2s1400KbpsMethod>
 #endif
 //TM1814 (RGBW)
-#define B_32_RN_TM1_4 NeoPixelBrightnessBus<NeoWrgbTm1814Feature, NeoEsp32RmtNTm1814Method>
+#define B_32_RN_TM1_4 NeoBusDriver<NeoWrgbTm1814Feature, NeoEsp32RmtNTm1814Method, DRV_BEGIN_TM1814>
 #ifndef CONFIG_IDF_TARGET_ESP32C3
-#define B_32_I0_TM1_4 NeoPixelBrightnessBus<NeoWrgbTm1814Feature, NeoEsp32I2s0Tm1814Method>
+#define B_32_I0_TM1_4 NeoBusDriver<NeoWrgbTm1814Feature, NeoEsp32I2s0Tm1814Method, DRV_BEGIN_TM1814>
 #endif
 #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-#define B_32_I1_TM1_4 NeoPixelBrightnessBus<NeoWrgbTm1814Feature, NeoEsp32I2s1Tm1814Method>
+#define B_32_I1_TM1_4 NeoBusDriver<NeoWrgbTm1814Feature, NeoEsp32I2s1Tm1814Method, DRV_BEGIN_TM1814>
 #endif
 //Bit Bang theoratically possible, but very undesirable and not needed (no pin restrictions on RMT and I2S)
 
+//Parallel I2S: up to 16 buses share the DMA buffer of I2S1 and are clocked out together (needs NeoPixelBus 2.7+)
+//The bits of all lanes are transposed into the DMA buffer by NeoPixelBus (NeoEsp32I2sXMethod.h), not by WLED.
+//WLED only hands each lane its pixels, the DMA layout is not tested here
+#ifdef WLED_USE_PARALLEL_I2S
+#define B_32_PX_NEO_3 NeoBusDriver<NeoGrbFeature, NeoEsp32I2s1X16Ws2812xMethod>
+#define B_32_PX_NEO_4 NeoBusDriver<NeoGrbwFeature, NeoEsp32I2s1X16Ws2812xMethod>
+#define B_32_PX_400_3 NeoBusDriver<NeoGrbFeature, NeoEsp32I2s1X16400KbpsMethod>
+#define B_32_PX_TM1_4 NeoBusDriver<NeoWrgbTm1814Feature, NeoEsp32I2s1X16Tm1814Method, DRV_BEGIN_TM1814>
 #endif
 
-//APA102
-#define B_HS_DOT_3 NeoPixelBrightnessBus<DotStarBgrFeature, DotStarSpi5MhzMethod> //hardware SPI
-#define B_SS_DOT_3 NeoPixelBrightnessBus<DotStarBgrFeature, DotStarMethod>    //soft SPI
+#endif
+
+//APA102, the Lbgr feature takes the 5 bit global brightness in W (see apa102Split())
+#ifndef WLED_DISABLE_APA102_GLOBAL_BRI
+#define B_HS_DOT_3 NeoBusDriver<DotStarLbgrFeature, DotStarSpi5MhzMethod, DRV_BEGIN_HSPI> //hardware SPI
+#define B_SS_DOT_3 NeoBusDriver<DotStarLbgrFeature, DotStarMethod>    //soft SPI
+#else
+#define B_HS_DOT_3 NeoBusDriver<DotStarBgrFeature, DotStarSpi5MhzMethod, DRV_BEGIN_HSPI> //hardware SPI
+#define B_SS_DOT_3 NeoBusDriver<DotStarBgrFeature, DotStarMethod>    //soft SPI
+#endif
 
 //LPD8806
-#define B_HS_LPD_3 NeoPixelBrightnessBus<Lpd8806GrbFeature, Lpd8806SpiMethod>
-#define B_SS_LPD_3 NeoPixelBrightnessBus<Lpd8806GrbFeature, Lpd8806Method>
+#define B_HS_LPD_3 NeoBusDriver<Lpd8806GrbFeature, Lpd8806SpiMethod, DRV_BEGIN_HSPI>
+#define B_SS_LPD_3 NeoBusDriver<Lpd8806GrbFeature, Lpd8806Method>
 
 //LPD6803
-#define B_HS_LPO_3 NeoPixelBrightnessBus<Lpd6803GrbFeature, Lpd6803SpiMethod>
-#define B_SS_LPO_3 NeoPixelBrightnessBus<Lpd6803GrbFeature, Lpd6803Method>
+#define B_HS_LPO_3 NeoBusDriver<Lpd6803GrbFeature, Lpd6803SpiMethod, DRV_BEGIN_HSPI>
+#define B_SS_LPO_3 NeoBusDriver<Lpd6803GrbFeature, Lpd6803Method>
 
 //WS2801
-//#define B_HS_WS1_3 NeoPixelBrightnessBus<NeoRbgFeature, NeoWs2801Spi40MhzMethod>
-//#define B_HS_WS1_3 NeoPixelBrightnessBus<NeoRbgFeature, NeoWs2801Spi20MhzMethod>
-//#define B_HS_WS1_3 NeoPixelBrightnessBus<NeoRbgFeature, NeoWs2801SpiMethod>     // 10MHz
-#define B_HS_WS1_3 NeoPixelBrightnessBus<NeoRbgFeature, NeoWs2801Spi2MhzMethod> //slower, more compatible
-#define B_SS_WS1_3 NeoPixelBrightnessBus<NeoRbgFeature, NeoWs2801Method>
+//#define B_HS_WS1_3 NeoBusDriver<NeoRbgFeature, NeoWs2801Spi40MhzMethod, DRV_BEGIN_HSPI>
+//#define B_HS_WS1_3 NeoBusDriver<NeoRbgFeature, NeoWs2801Spi20MhzMethod, DRV_BEGIN_HSPI>
+//#define B_HS_WS1_3 NeoBusDriver<NeoRbgFeature, NeoWs2801SpiMethod, DRV_BEGIN_HSPI>     // 10MHz
+#define B_HS_WS1_3 NeoBusDriver<NeoRbgFeature, NeoWs2801Spi2MhzMethod, DRV_BEGIN_HSPI> //slower, more compatible
+#define B_SS_WS1_3 NeoBusDriver<NeoRbgFeature, NeoWs2801Method>
 
 //P9813
-#define B_HS_P98_3 NeoPixelBrightnessBus<P9813BgrFeature, P9813SpiMethod>
-#define B_SS_P98_3 NeoPixelBrightnessBus<P9813BgrFeature, P9813Method>
+#define B_HS_P98_3 NeoBusDriver<P9813BgrFeature, P9813SpiMethod, DRV_BEGIN_HSPI>
+#define B_SS_P98_3 NeoBusDriver<P9813BgrFeature, P9813Method>
 
-//handles pointer type conversion for all possible bus types
-class PolyBus {
+/*
+ * Type-erased interface to one NeoPixelBus instance.
+ * Colors passed to setPixelColor() and returned by getPixelColor() are already in wire order,
+ * encode() applies the color order itself while copying a span of WLED colors into the driver.
+ * Brightness is applied on the way into the driver, by encode() or setPixelColor(), never to colors the caller keeps.
+ * With dither set, encode() may spread the brightness scaling over consecutive frames (temporal dithering).
+ * Anything implementing it can serve as the output of a BusDigital, e.g. a mock driver for benchmarks.
+ */
+class PolyDriver {
   public:
-  // Begin & initialize the PixelSettings for TM1814 strips.
-  template <class T>
-  static void beginTM1814(void* busPtr) {
-    T tm1814_strip = static_cast<T>(busPtr);
-    tm1814_strip->Begin();
-    // Max current for each LED (22.5 mA).
-    tm1814_strip->SetPixelSettings(NeoTm1814Settings(/*R*/225, /*G*/225, /*B*/225, /*W*/225));
+  virtual ~PolyDriver() {}
+  virtual void     begin(uint8_t* pins) = 0;
+  virtual void     show() = 0;
+  virtual bool     canShow() = 0;
+  virtual void     setBrightness(uint8_t b) = 0;
+  virtual void     setPixelColor(uint16_t pix, uint32_t c) = 0;
+  virtual uint32_t getPixelColor(uint16_t pix) = 0;
+  virtual void     encode(const uint32_t* data, uint16_t pix, uint16_t count, const uint8_t* shifts, bool dither = false) = 0;
+};
+
+//converts a wire order RGBW value to the color object of the NeoPixelBus feature
+inline RgbColor  neoColor(uint32_t c, RgbColor*)  { return RgbColor(c >> 16, c >> 8, c); }
+inline RgbwColor neoColor(uint32_t c, RgbwColor*) { return RgbwColor(c >> 16, c >> 8, c, c >> 24); }
+
+/*
+ * Driver for a NeoPixelBus of feature F and method M.
+ * All calls resolve to the concrete bus at compile time, so the only indirection per pixel is the PolyDriver vtable.
+ * Unlike NeoPixelBrightnessBus, a brightness change only rescales the bus buffer if pixels were written with
+ * setPixelColor() (BusDigital without its own pixel buffer). Otherwise the next encode() applies it for free.
+ */
+template <class F, class M, uint8_t B = DRV_BEGIN_DEFAULT>
+class NeoBusDriver : public PolyDriver {
+  public:
+  template <typename... A>
+  NeoBusDriver(A... args) : _bus(args...) {}
+  #ifndef WLED_DISABLE_DITHERING
+  ~NeoBusDriver() { free(_residual); }
+  #endif
+
+  void begin(uint8_t* pins) { begin(pins, (BeginTag<B>*)nullptr); }
+  void show() { _bus.Show(); }
+  bool canShow() { return _bus.CanShow(); }
+
+  void setBrightness(uint8_t b) {
+    if (b == _bri) return;
+    uint8_t oldBri = _bri;
+    _bri = b;
+    if (!_direct) return;
+    //the bus buffer holds the only copy of the pixels, scale them to the new brightness
+    for (uint16_t i = 0; i < _bus.PixelCount(); i++) setPixelColor(i, unscaled(i, oldBri, (F*)nullptr));
   }
-  static void begin(void* busPtr, uint8_t busType, uint8_t* pins) {
-    switch (busType) {
-      case I_NONE: break;
-    #ifdef ESP8266
-      case I_8266_U0_NEO_3: (static_cast<B_8266_U0_NEO_3*>(busPtr))->Begin(); break;
-      case I_8266_U1_NEO_3: (static_cast<B_8266_U1_NEO_3*>(busPtr))->Begin(); break;
-      case I_8266_DM_NEO_3: (static_cast<B_8266_DM_NEO_3*>(busPtr))->Begin(); break;
-      case I_8266_BB_NEO_3: (static_cast<B_8266_BB_NEO_3*>(busPtr))->Begin(); break;
-      case I_8266_U0_NEO_4: (static_cast<B_8266_U0_NEO_4*>(busPtr))->Begin(); break;
-      case I_8266_U1_NEO_4: (static_cast<B_8266_U1_NEO_4*>(busPtr))->Begin(); break;
-      case I_8266_DM_NEO_4: (static_cast<B_8266_DM_NEO_4*>(busPtr))->Begin(); break;
-      case I_8266_BB_NEO_4: (static_cast<B_8266_BB_NEO_4*>(busPtr))->Begin(); break;
-      case I_8266_U0_400_3: (static_cast<B_8266_U0_400_3*>(busPtr))->Begin(); break;
-      case I_8266_U1_400_3: (static_cast<B_8266_U1_400_3*>(busPtr))->Begin(); break;
-      case I_8266_DM_400_3: (static_cast<B_8266_DM_400_3*>(busPtr))->Begin(); break;
-      case I_8266_BB_400_3: (static_cast<B_8266_BB_400_3*>(busPtr))->Begin(); break;
-      case I_8266_U0_TM1_4: beginTM1814<B_8266_U0_TM1_4*>(busPtr); break;
-      case I_8266_U1_TM1_4: beginTM1814<B_8266_U1_TM1_4*>(busPtr); break;
-      case I_8266_DM_TM1_4: beginTM1814<B_8266_DM_TM1_4*>(busPtr); break;
-      case I_8266_BB_TM1_4: beginTM1814<B_8266_BB_TM1_4*>(busPtr); break;
-      case I_HS_DOT_3: (static_cast<B_HS_DOT_3*>(busPtr))->Begin(); break;
-      case I_HS_LPD_3: (static_cast<B_HS_LPD_3*>(busPtr))->Begin(); break;
-      case I_HS_LPO_3: (static_cast<B_HS_LPO_3*>(busPtr))->Begin(); break;
-      case I_HS_WS1_3: (static_cast<B_HS_WS1_3*>(busPtr))->Begin(); break;
-      case I_HS_P98_3: (static_cast<B_HS_P98_3*>(busPtr))->Begin(); break;
-    #endif
-    #ifdef ARDUINO_ARCH_ESP32
-      case I_32_RN_NEO_3: (static_cast<B_32_RN_NEO_3*>(busPtr))->Begin(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_3: (static_cast<B_32_I0_NEO_3*>(busPtr))->Begin(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_3: (static_cast<B_32_I1_NEO_3*>(busPtr))->Begin(); break;
-      #endif
-      case I_32_RN_NEO_4: (static_cast<B_32_RN_NEO_4*>(busPtr))->Begin(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_4: (static_cast<B_32_I0_NEO_4*>(busPtr))->Begin(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_4: (static_cast<B_32_I1_NEO_4*>(busPtr))->Begin(); break;
-      #endif
-      case I_32_RN_400_3: (static_cast<B_32_RN_400_3*>(busPtr))->Begin(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_400_3: (static_cast<B_32_I0_400_3*>(busPtr))->Begin(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_400_3: (static_cast<B_32_I1_400_3*>(busPtr))->Begin(); break;
-      #endif
-      case I_32_RN_TM1_4: beginTM1814<B_32_RN_TM1_4*>(busPtr); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_TM1_4: beginTM1814<B_32_I0_TM1_4*>(busPtr); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_TM1_4: beginTM1814<B_32_I1_TM1_4*>(busPtr); break;
-      #endif
-      // ESP32 can (and should, to avoid inadvertantly driving the chip select signal) specify the pins used for SPI, but only in begin()
-      case I_HS_DOT_3: (static_cast<B_HS_DOT_3*>(busPtr))->Begin(pins[1], -1, pins[0], -1); break;
-      case I_HS_LPD_3: (static_cast<B_HS_LPD_3*>(busPtr))->Begin(pins[1], -1, pins[0], -1); break;
-      case I_HS_LPO_3: (static_cast<B_HS_LPO_3*>(busPtr))->Begin(pins[1], -1, pins[0], -1); break;
-      case I_HS_WS1_3: (static_cast<B_HS_WS1_3*>(busPtr))->Begin(pins[1], -1, pins[0], -1); break;
-      case I_HS_P98_3: (static_cast<B_HS_P98_3*>(busPtr))->Begin(pins[1], -1, pins[0], -1); break;
+
+  void setPixelColor(uint16_t pix, uint32_t c) {
+    _direct = true;
+    _bus.SetPixelColor(pix, scaled(c, _bri, (F*)nullptr));
+  }
+
+  //undoes the brightness scaling, lossy for brightness < 255
+  uint32_t getPixelColor(uint16_t pix) {
+    return unscaled(pix, _bri, (F*)nullptr);
+  }
+
+  void encode(const uint32_t* data, uint16_t pix, uint16_t count, const uint8_t* shifts, bool dither = false) {
+    if (_bri == 255 || !canDither((F*)nullptr)) {
+      for (uint16_t i = 0; i < count; i++) {
+        _bus.SetPixelColor(pix + i, scaled(toWireOrder(data[i], shifts), _bri, (F*)nullptr));
+      }
+    #ifndef WLED_DISABLE_DITHERING
+    } else if (dither && (_residual || (_residual = (uint8_t*)calloc(_bus.PixelCount(), 4)))) {
+      uint8_t* res = _residual + pix*4;
+      for (uint16_t i = 0; i < count; i++, res += 4) {
+        _bus.SetPixelColor(pix + i, neoColor(scaleBriDither(toWireOrder(data[i], shifts), _bri, res), (typename F::ColorObject*)nullptr));
+      }
     #endif
-      case I_SS_DOT_3: (static_cast<B_SS_DOT_3*>(busPtr))->Begin(); break;
-      case I_SS_LPD_3: (static_cast<B_SS_LPD_3*>(busPtr))->Begin(); break;
-      case I_SS_LPO_3: (static_cast<B_SS_LPO_3*>(busPtr))->Begin(); break;
-      case I_SS_WS1_3: (static_cast<B_SS_WS1_3*>(busPtr))->Begin(); break;
-      case I_SS_P98_3: (static_cast<B_SS_P98_3*>(busPtr))->Begin(); break;
+    } else {
+      for (uint16_t i = 0; i < count; i++) {
+        _bus.SetPixelColor(pix + i, neoColor(toWireOrder(scaleBri(data[i], _bri), shifts), (typename F::ColorObject*)nullptr));
+      }
     }
-  };
-  static void* create(uint8_t busType, uint8_t* pins, uint16_t len, uint8_t channel) {
-    void* busPtr = nullptr;
-    switch (busType) {
-      case I_NONE: break;
-    #ifdef ESP8266
-      case I_8266_U0_NEO_3: busPtr = new B_8266_U0_NEO_3(len, pins[0]); break;
-      case I_8266_U1_NEO_3: busPtr = new B_8266_U1_NEO_3(len, pins[0]); break;
-      case I_8266_DM_NEO_3: busPtr = new B_8266_DM_NEO_3(len, pins[0]); break;
-      case I_8266_BB_NEO_3: busPtr = new B_8266_BB_NEO_3(len, pins[0]); break;
-      case I_8266_U0_NEO_4: busPtr = new B_8266_U0_NEO_4(len, pins[0]); break;
-      case I_8266_U1_NEO_4: busPtr = new B_8266_U1_NEO_4(len, pins[0]); break;
-      case I_8266_DM_NEO_4: busPtr = new B_8266_DM_NEO_4(len, pins[0]); break;
-      case I_8266_BB_NEO_4: busPtr = new B_8266_BB_NEO_4(len, pins[0]); break;
-      case I_8266_U0_400_3: busPtr = new B_8266_U0_400_3(len, pins[0]); break;
-      case I_8266_U1_400_3: busPtr = new B_8266_U1_400_3(len, pins[0]); break;
-      case I_8266_DM_400_3: busPtr = new B_8266_DM_400_3(len, pins[0]); break;
-      case I_8266_BB_400_3: busPtr = new B_8266_BB_400_3(len, pins[0]); break;
-      case I_8266_U0_TM1_4: busPtr = new B_8266_U0_TM1_4(len, pins[0]); break;
-      case I_8266_U1_TM1_4: busPtr = new B_8266_U1_TM1_4(len, pins[0]); break;
-      case I_8266_DM_TM1_4: busPtr = new B_8266_DM_TM1_4(len, pins[0]); break;
-      case I_8266_BB_TM1_4: busPtr = new B_8266_BB_TM1_4(len, pins[0]); break;
-    #endif
-    #ifdef ARDUINO_ARCH_ESP32
-      case I_32_RN_NEO_3: busPtr = new B_32_RN_NEO_3(len, pins[0], (NeoBusChannel)channel); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_3: busPtr = new B_32_I0_NEO_3(len, pins[0]); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_3: busPtr = new B_32_I1_NEO_3(len, pins[0]); break;
-      #endif
-      case I_32_RN_NEO_4: busPtr = new B_32_RN_NEO_4(len, pins[0], (NeoBusChannel)channel); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_4: busPtr = new B_32_I0_NEO_4(len, pins[0]); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_4: busPtr = new B_32_I1_NEO_4(len, pins[0]); break;
-      #endif
-      case I_32_RN_400_3: busPtr = new B_32_RN_400_3(len, pins[0], (NeoBusChannel)channel); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_400_3: busPtr = new B_32_I0_400_3(len, pins[0]); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_400_3: busPtr = new B_32_I1_400_3(len, pins[0]); break;
-      #endif
-      case I_32_RN_TM1_4: busPtr = new B_32_RN_TM1_4(len, pins[0], (NeoBusChannel)channel); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_TM1_4: busPtr = new B_32_I0_TM1_4(len, pins[0]); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_TM1_4: busPtr = new B_32_I1_TM1_4(len, pins[0]); break;
-      #endif
-    #endif
-      // for 2-wire: pins[1] is clk, pins[0] is dat.  begin expects (len, clk, dat)
-      case I_HS_DOT_3: busPtr = new B_HS_DOT_3(len, pins[1], pins[0]); break;
-      case I_SS_DOT_3: busPtr = new B_SS_DOT_3(len, pins[1], pins[0]); break;
-      case I_HS_LPD_3: busPtr = new B_HS_LPD_3(len, pins[1], pins[0]); break;
-      case I_SS_LPD_3: busPtr = new B_SS_LPD_3(len, pins[1], pins[0]); break;
-      case I_HS_LPO_3: busPtr = new B_HS_LPO_3(len, pins[1], pins[0]); break;
-      case I_SS_LPO_3: busPtr = new B_SS_LPO_3(len, pins[1], pins[0]); break;
-      case I_HS_WS1_3: busPtr = new B_HS_WS1_3(len, pins[1], pins[0]); break;
-      case I_SS_WS1_3: busPtr = new B_SS_WS1_3(len, pins[1], pins[0]); break;
-      case I_HS_P98_3: busPtr = new B_HS_P98_3(len, pins[1], pins[0]); break;
-      case I_SS_P98_3: busPtr = new B_SS_P98_3(len, pins[1], pins[0]); break;
+  }
+
+  private:
+  template <uint8_t N> struct BeginTag {};
+
+  //the color object for c at brightness b, chips with a global brightness field get it from apa102Split()
+  template <class FF> static typename F::ColorObject scaled(uint32_t c, uint8_t b, FF*) {
+    return neoColor(b < 255 ? scaleBri(c, b) : c, (typename F::ColorObject*)nullptr);
+  }
+  template <class FF> uint32_t unscaled(uint16_t pix, uint8_t b, FF*) { return unscaleBri(readPixel(pix), b); }
+  template <class FF> static constexpr bool canDither(FF*) { return true; }
+  #ifndef WLED_DISABLE_APA102_GLOBAL_BRI
+  static RgbwColor scaled(uint32_t c, uint8_t b, DotStarLbgrFeature*) {
+    uint8_t r = c >> 16, g = c >> 8, bl = c;
+    uint8_t gb = apa102Split(r, g, bl, b);
+    return RgbwColor(r, g, bl, gb);
+  }
+  uint32_t unscaled(uint16_t pix, uint8_t b, DotStarLbgrFeature*) {
+    RgbwColor col = _bus.GetPixelColor(pix);
+    //a channel value v at global brightness gb is the intensity v*gb/31, which is the color scaled by (bri+1)/256
+    uint32_t d = 31 * (uint32_t(b) + 1);
+    uint32_t c = 0;
+    uint8_t ch[3] = {col.R, col.G, col.B};
+    for (uint8_t i = 0; i < 3; i++) {
+      uint32_t v = (uint32_t(ch[i]) * col.W * 256 + d/2) / d;
+      c = (c << 8) | (v > 255 ? 255 : v);
     }
-    begin(busPtr, busType, pins);
-    return busPtr;
-  };
-  static void show(void* busPtr, uint8_t busType) {
-    switch (busType) {
-      case I_NONE: break;
-    #ifdef ESP8266
-      case I_8266_U0_NEO_3: (static_cast<B_8266_U0_NEO_3*>(busPtr))->Show(); break;
-      case I_8266_U1_NEO_3: (static_cast<B_8266_U1_NEO_3*>(busPtr))->Show(); break;
-      case I_8266_DM_NEO_3: (static_cast<B_8266_DM_NEO_3*>(busPtr))->Show(); break;
-      case I_8266_BB_NEO_3: (static_cast<B_8266_BB_NEO_3*>(busPtr))->Show(); break;
-      case I_8266_U0_NEO_4: (static_cast<B_8266_U0_NEO_4*>(busPtr))->Show(); break;
-      case I_8266_U1_NEO_4: (static_cast<B_8266_U1_NEO_4*>(busPtr))->Show(); break;
-      case I_8266_DM_NEO_4: (static_cast<B_8266_DM_NEO_4*>(busPtr))->Show(); break;
-      case I_8266_BB_NEO_4: (static_cast<B_8266_BB_NEO_4*>(busPtr))->Show(); break;
-      case I_8266_U0_400_3: (static_cast<B_8266_U0_400_3*>(busPtr))->Show(); break;
-      case I_8266_U1_400_3: (static_cast<B_8266_U1_400_3*>(busPtr))->Show(); break;
-      case I_8266_DM_400_3: (static_cast<B_8266_DM_400_3*>(busPtr))->Show(); break;
-      case I_8266_BB_400_3: (static_cast<B_8266_BB_400_3*>(busPtr))->Show(); break;
-      case I_8266_U0_TM1_4: (static_cast<B_8266_U0_TM1_4*>(busPtr))->Show(); break;
-      case I_8266_U1_TM1_4: (static_cast<B_8266_U1_TM1_4*>(busPtr))->Show(); break;
-      case I_8266_DM_TM1_4: (static_cast<B_8266_DM_TM1_4*>(busPtr))->Show(); break;
-      case I_8266_BB_TM1_4: (static_cast<B_8266_BB_TM1_4*>(busPtr))->Show(); break;
-    #endif
-    #ifdef ARDUINO_ARCH_ESP32
-      case I_32_RN_NEO_3: (static_cast<B_32_RN_NEO_3*>(busPtr))->Show(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_3: (static_cast<B_32_I0_NEO_3*>(busPtr))->Show(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_3: (static_cast<B_32_I1_NEO_3*>(busPtr))->Show(); break;
-      #endif
-      case I_32_RN_NEO_4: (static_cast<B_32_RN_NEO_4*>(busPtr))->Show(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_4: (static_cast<B_32_I0_NEO_4*>(busPtr))->Show(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_4: (static_cast<B_32_I1_NEO_4*>(busPtr))->Show(); break;
-      #endif
-      case I_32_RN_400_3: (static_cast<B_32_RN_400_3*>(busPtr))->Show(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_400_3: (static_cast<B_32_I0_400_3*>(busPtr))->Show(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_400_3: (static_cast<B_32_I1_400_3*>(busPtr))->Show(); break;
-      #endif
-      case I_32_RN_TM1_4: (static_cast<B_32_RN_TM1_4*>(busPtr))->Show(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_TM1_4: (static_cast<B_32_I0_TM1_4*>(busPtr))->Show(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_TM1_4: (static_cast<B_32_I1_TM1_4*>(busPtr))->Show(); break;
-      #endif
-    #endif
-      case I_HS_DOT_3: (static_cast<B_HS_DOT_3*>(busPtr))->Show(); break;
-      case I_SS_DOT_3: (static_cast<B_SS_DOT_3*>(busPtr))->Show(); break;
-      case I_HS_LPD_3: (static_cast<B_HS_LPD_3*>(busPtr))->Show(); break;
-      case I_SS_LPD_3: (static_cast<B_SS_LPD_3*>(busPtr))->Show(); break;
-      case I_HS_LPO_3: (static_cast<B_HS_LPO_3*>(busPtr))->Show(); break;
-      case I_SS_LPO_3: (static_cast<B_SS_LPO_3*>(busPtr))->Show(); break;
-      case I_HS_WS1_3: (static_cast<B_HS_WS1_3*>(busPtr))->Show(); break;
-      case I_SS_WS1_3: (static_cast<B_SS_WS1_3*>(busPtr))->Show(); break;
-      case I_HS_P98_3: (static_cast<B_HS_P98_3*>(busPtr))->Show(); break;
-      case I_SS_P98_3: (static_cast<B_SS_P98_3*>(busPtr))->Show(); break;
+    return c;
+  }
+  static constexpr bool canDither(DotStarLbgrFeature*) { return false; } //the global brightness already keeps the resolution
+  #endif
+
+  uint32_t readPixel(uint16_t pix) {
+    RgbwColor col = _bus.GetPixelColor(pix);
+    return ((col.W << 24) | (col.R << 16) | (col.G << 8) | (col.B));
+  }
+
+  static uint32_t unscaleBri(uint32_t c, uint8_t b) {
+    if (b == 255 || !b) return c;
+    uint8_t* ch = (uint8_t*)&c;
+    for (uint8_t i = 0; i < 4; i++) {
+      uint16_t v = (uint16_t(ch[i]) << 8) / (b + 1);
+      ch[i] = v > 255 ? 255 : v;
     }
-  };
-  static bool canShow(void* busPtr, uint8_t busType) {
-    switch (busType) {
-      case I_NONE: return true;
-    #ifdef ESP8266
-      case I_8266_U0_NEO_3: return (static_cast<B_8266_U0_NEO_3*>(busPtr))->CanShow(); break;
-      case I_8266_U1_NEO_3: return (static_cast<B_8266_U1_NEO_3*>(busPtr))->CanShow(); break;
-      case I_8266_DM_NEO_3: return (static_cast<B_8266_DM_NEO_3*>(busPtr))->CanShow(); break;
-      case I_8266_BB_NEO_3: return (static_cast<B_8266_BB_NEO_3*>(busPtr))->CanShow(); break;
-      case I_8266_U0_NEO_4: return (static_cast<B_8266_U0_NEO_4*>(busPtr))->CanShow(); break;
-      case I_8266_U1_NEO_4: return (static_cast<B_8266_U1_NEO_4*>(busPtr))->CanShow(); break;
-      case I_8266_DM_NEO_4: return (static_cast<B_8266_DM_NEO_4*>(busPtr))->CanShow(); break;
-      case I_8266_BB_NEO_4: return (static_cast<B_8266_BB_NEO_4*>(busPtr))->CanShow(); break;
-      case I_8266_U0_400_3: return (static_cast<B_8266_U0_400_3*>(busPtr))->CanShow(); break;
-      case I_8266_U1_400_3: return (static_cast<B_8266_U1_400_3*>(busPtr))->CanShow(); break;
-      case I_8266_DM_400_3: return (static_cast<B_8266_DM_400_3*>(busPtr))->CanShow(); break;
-      case I_8266_BB_400_3: return (static_cast<B_8266_BB_400_3*>(busPtr))->CanShow(); break;
-      case I_8266_U0_TM1_4: return (static_cast<B_8266_U0_TM1_4*>(busPtr))->CanShow(); break;
-      case I_8266_U1_TM1_4: return (static_cast<B_8266_U1_TM1_4*>(busPtr))->CanShow(); break;
-      case I_8266_DM_TM1_4: return (static_cast<B_8266_DM_TM1_4*>(busPtr))->CanShow(); break;
-      case I_8266_BB_TM1_4: return (static_cast<B_8266_BB_TM1_4*>(busPtr))->CanShow(); break;
-    #endif
-    #ifdef ARDUINO_ARCH_ESP32
-      case I_32_RN_NEO_3: return (static_cast<B_32_RN_NEO_3*>(busPtr))->CanShow(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_3: return (static_cast<B_32_I0_NEO_3*>(busPtr))->CanShow(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_3: return (static_cast<B_32_I1_NEO_3*>(busPtr))->CanShow(); break;
-      #endif
-      case I_32_RN_NEO_4: return (static_cast<B_32_RN_NEO_4*>(busPtr))->CanShow(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_4: return (static_cast<B_32_I0_NEO_4*>(busPtr))->CanShow(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_4: return (static_cast<B_32_I1_NEO_4*>(busPtr))->CanShow(); break;
-      #endif
-      case I_32_RN_400_3: return (static_cast<B_32_RN_400_3*>(busPtr))->CanShow(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_400_3: return (static_cast<B_32_I0_400_3*>(busPtr))->CanShow(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_400_3: return (static_cast<B_32_I1_400_3*>(busPtr))->CanShow(); break;
-      #endif
-      case I_32_RN_TM1_4: return (static_cast<B_32_RN_TM1_4*>(busPtr))->CanShow(); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_TM1_4: return (static_cast<B_32_I0_TM1_4*>(busPtr))->CanShow(); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_TM1_4: return (static_cast<B_32_I1_TM1_4*>(busPtr))->CanShow(); break;
-      #endif
+    return c;
+  }
+
+  void begin(uint8_t* pins, BeginTag<DRV_BEGIN_DEFAULT>*) { _bus.Begin(); }
+  // Begin & initialize the PixelSettings for TM1814 strips.
+  void begin(uint8_t* pins, BeginTag<DRV_BEGIN_TM1814>*) {
+    _bus.Begin();
+    // Max current for each LED (22.5 mA).
+    _bus.SetPixelSettings(NeoTm1814Settings(/*R*/225, /*G*/225, /*B*/225, /*W*/225));
+  }
+  // ESP32 can (and should, to avoid inadvertantly driving the chip select signal) specify the pins used for SPI, but only in begin()
+  void begin(uint8_t* pins, BeginTag<DRV_BEGIN_SPI>*) { _bus.Begin(pins[1], -1, pins[0], -1); }
+
+  NeoPixelBus<F, M> _bus;
+  uint8_t _bri = 255;
+  bool _direct = false; //pixels were set directly instead of encoded from a WLED buffer
+  #ifndef WLED_DISABLE_DITHERING
+  uint8_t* _residual = nullptr; //dithering remainder per channel and pixel, allocated on first use
+  #endif
+};
+
+#ifdef ARDUINO_ARCH_ESP32
+/*
+ * Hardware SPI driver for 2-wire chips (I_32_DS_XXX_3 types) on the ESP32.
+ * The whole frame, including start and end frames, is built into a DMA capable buffer and queued on an SPI host,
+ * so show() returns right away and canShow() reports when the transfer is finished.
+ * Each driver occupies one general purpose SPI host reserved through the PinManager,
+ * create() returns nullptr if none is free so the bus falls back to software SPI.
+ */
+class SpiDmaDriver : public PolyDriver {
+  public:
+  static SpiDmaDriver* create(uint8_t busType, uint8_t* pins, uint16_t len) {
+    #if defined(CONFIG_IDF_TARGET_ESP32C3)
+    const spi_host_device_t hosts[] = {SPI2_HOST};
+    #elif defined(CONFIG_IDF_TARGET_ESP32S2)
+    const spi_host_device_t hosts[] = {SPI2_HOST, SPI3_HOST};
+    #else
+    const spi_host_device_t hosts[] = {HSPI_HOST, VSPI_HOST};
     #endif
-      case I_HS_DOT_3: return (static_cast<B_HS_DOT_3*>(busPtr))->CanShow(); break;
-      case I_SS_DOT_3: return (static_cast<B_SS_DOT_3*>(busPtr))->CanShow(); break;
-      case I_HS_LPD_3: return (static_cast<B_HS_LPD_3*>(busPtr))->CanShow(); break;
-      case I_SS_LPD_3: return (static_cast<B_SS_LPD_3*>(busPtr))->CanShow(); break;
-      case I_HS_LPO_3: return (static_cast<B_HS_LPO_3*>(busPtr))->CanShow(); break;
-      case I_SS_LPO_3: return (static_cast<B_SS_LPO_3*>(busPtr))->CanShow(); break;
-      case I_HS_WS1_3: return (static_cast<B_HS_WS1_3*>(busPtr))->CanShow(); break;
-      case I_SS_WS1_3: return (static_cast<B_SS_WS1_3*>(busPtr))->CanShow(); break;
-      case I_HS_P98_3: return (static_cast<B_HS_P98_3*>(busPtr))->CanShow(); break;
-      case I_SS_P98_3: return (static_cast<B_SS_P98_3*>(busPtr))->CanShow(); break;
+    for (uint8_t h = 0; h < sizeof(hosts)/sizeof(hosts[0]); h++) {
+      if (!pinManager.allocateSpiHost(h, PinOwner::BusDigital)) continue; //in use by another bus or a usermod
+      SpiDmaDriver* drv = new SpiDmaDriver(busType, len, h);
+      if (drv->init(hosts[h], pins)) return drv;
+      delete drv; //gives the host back
+      return nullptr;
     }
-    return true;
-  };
-  static void setPixelColor(void* busPtr, uint8_t busType, uint16_t pix, uint32_t c, uint8_t co) {
-    uint8_t r = c >> 16;
-    uint8_t g = c >> 8;
-    uint8_t b = c >> 0;
-    uint8_t w = c >> 24;
-    RgbwColor col;
-
-    //TODO make color order override possible on a per-strip basis
-    #ifdef COLOR_ORDER_OVERRIDE
-    if (pix >= COO_MIN && pix < COO_MAX) co = COO_ORDER;
-    #endif
+    return nullptr;
+  }
 
-    //reorder channels to selected order
-    switch (co)
-    {
-      case  0: col.G = g; col.R = r; col.B = b; break; //0 = GRB, default
-      case  1: col.G = r; col.R = g; col.B = b; break; //1 = RGB, common for WS2811
-      case  2: col.G = b; col.R = r; col.B = g; break; //2 = BRG
-      case  3: col.G = r; col.R = b; col.B = g; break; //3 = RBG
-      case  4: col.G = b; col.R = g; col.B = r; break; //4 = BGR
-      default: col.G = g; col.R = b; col.B = r; break; //5 = GBR
+  ~SpiDmaDriver() {
+    if (_spi) {
+      waitDone(portMAX_DELAY);
+      spi_bus_remove_device(_spi);
+      spi_bus_free(_host);
     }
-    col.W = w;
+    pinManager.deallocateSpiHost(_hostIdx, PinOwner::BusDigital);
+    heap_caps_free(_frame);
+    free(_pixels);
+  }
 
-    switch (busType) {
-      case I_NONE: break;
-    #ifdef ESP8266
-      case I_8266_U0_NEO_3: (static_cast<B_8266_U0_NEO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_8266_U1_NEO_3: (static_cast<B_8266_U1_NEO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_8266_DM_NEO_3: (static_cast<B_8266_DM_NEO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_8266_BB_NEO_3: (static_cast<B_8266_BB_NEO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_8266_U0_NEO_4: (static_cast<B_8266_U0_NEO_4*>(busPtr))->SetPixelColor(pix, col); break;
-      case I_8266_U1_NEO_4: (static_cast<B_8266_U1_NEO_4*>(busPtr))->SetPixelColor(pix, col); break;
-      case I_8266_DM_NEO_4: (static_cast<B_8266_DM_NEO_4*>(busPtr))->SetPixelColor(pix, col); break;
-      case I_8266_BB_NEO_4: (static_cast<B_8266_BB_NEO_4*>(busPtr))->SetPixelColor(pix, col); break;
-      case I_8266_U0_400_3: (static_cast<B_8266_U0_400_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_8266_U1_400_3: (static_cast<B_8266_U1_400_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_8266_DM_400_3: (static_cast<B_8266_DM_400_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_8266_BB_400_3: (static_cast<B_8266_BB_400_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_8266_U0_TM1_4: (static_cast<B_8266_U0_TM1_4*>(busPtr))->SetPixelColor(pix, col); break;
-      case I_8266_U1_TM1_4: (static_cast<B_8266_U1_TM1_4*>(busPtr))->SetPixelColor(pix, col); break;
-      case I_8266_DM_TM1_4: (static_cast<B_8266_DM_TM1_4*>(busPtr))->SetPixelColor(pix, col); break;
-      case I_8266_BB_TM1_4: (static_cast<B_8266_BB_TM1_4*>(busPtr))->SetPixelColor(pix, col); break;
-    #endif
-    #ifdef ARDUINO_ARCH_ESP32
-      case I_32_RN_NEO_3: (static_cast<B_32_RN_NEO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_3: (static_cast<B_32_I0_NEO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_3: (static_cast<B_32_I1_NEO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      #endif
-      case I_32_RN_NEO_4: (static_cast<B_32_RN_NEO_4*>(busPtr))->SetPixelColor(pix, col); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_4: (static_cast<B_32_I0_NEO_4*>(busPtr))->SetPixelColor(pix, col); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_4: (static_cast<B_32_I1_NEO_4*>(busPtr))->SetPixelColor(pix, col); break;
-      #endif
-      case I_32_RN_400_3: (static_cast<B_32_RN_400_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_400_3: (static_cast<B_32_I0_400_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_400_3: (static_cast<B_32_I1_400_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      #endif
-      case I_32_RN_TM1_4: (static_cast<B_32_RN_TM1_4*>(busPtr))->SetPixelColor(pix, col); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_TM1_4: (static_cast<B_32_I0_TM1_4*>(busPtr))->SetPixelColor(pix, col); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_TM1_4: (static_cast<B_32_I1_TM1_4*>(busPtr))->SetPixelColor(pix, col); break;
+  void begin(uint8_t* pins) {} //the SPI host is set up by create()
+
+  void show() {
+    waitDone(portMAX_DELAY); //BusManager only shows when canShow(), so this does not wait in practice
+    uint8_t* p = _frame + _startLen;
+    for (uint16_t i = 0; i < _len; i++) {
+      #ifndef WLED_DISABLE_APA102_GLOBAL_BRI
+      if (_type == I_32_DS_DOT_3) { //BGR, brightness goes into the 5 bit global brightness where possible
+        uint8_t r = _pixels[i] >> 16, g = _pixels[i] >> 8, b = _pixels[i];
+        *p++ = 0xE0 | apa102Split(r, g, b, _bri); *p++ = b; *p++ = g; *p++ = r;
+        continue;
+      }
       #endif
-    #endif
-      case I_HS_DOT_3: (static_cast<B_HS_DOT_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_SS_DOT_3: (static_cast<B_SS_DOT_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_HS_LPD_3: (static_cast<B_HS_LPD_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_SS_LPD_3: (static_cast<B_SS_LPD_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_HS_LPO_3: (static_cast<B_HS_LPO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_SS_LPO_3: (static_cast<B_SS_LPO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_HS_WS1_3: (static_cast<B_HS_WS1_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_SS_WS1_3: (static_cast<B_SS_WS1_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_HS_P98_3: (static_cast<B_HS_P98_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
-      case I_SS_P98_3: (static_cast<B_SS_P98_3*>(busPtr))->SetPixelColor(pix, RgbColor(col.R,col.G,col.B)); break;
+      uint32_t c = (_bri < 255) ? scaleBri(_pixels[i], _bri) : _pixels[i];
+      uint8_t r = c >> 16, g = c >> 8, b = c;
+      switch (_type) {
+        case I_32_DS_DOT_3: *p++ = 0xFF; *p++ = b; *p++ = g; *p++ = r; break; //BGR
+        case I_32_DS_LPD_3: *p++ = 0x80 | (g >> 1); *p++ = 0x80 | (r >> 1); *p++ = 0x80 | (b >> 1); break; //GRB, 7 bit
+        case I_32_DS_LPO_3: { //GRB, 5 bit
+          uint16_t v = 0x8000 | ((g & 0xF8) << 7) | ((r & 0xF8) << 2) | (b >> 3);
+          *p++ = v >> 8; *p++ = v; break;
+        }
+        case I_32_DS_WS1_3: *p++ = r; *p++ = b; *p++ = g; break; //RBG
+        case I_32_DS_P98_3: *p++ = 0xC0 | ((~b & 0xC0) >> 2) | ((~g & 0xC0) >> 4) | ((~r & 0xC0) >> 6); *p++ = b; *p++ = g; *p++ = r; break; //BGR with checksum
+      }
     }
-  };
-  static void setBrightness(void* busPtr, uint8_t busType, uint8_t b) {
-    switch (busType) {
-      case I_NONE: break;
-    #ifdef ESP8266
-      case I_8266_U0_NEO_3: (static_cast<B_8266_U0_NEO_3*>(busPtr))->SetBrightness(b); break;
-      case I_8266_U1_NEO_3: (static_cast<B_8266_U1_NEO_3*>(busPtr))->SetBrightness(b); break;
-      case I_8266_DM_NEO_3: (static_cast<B_8266_DM_NEO_3*>(busPtr))->SetBrightness(b); break;
-      case I_8266_BB_NEO_3: (static_cast<B_8266_BB_NEO_3*>(busPtr))->SetBrightness(b); break;
-      case I_8266_U0_NEO_4: (static_cast<B_8266_U0_NEO_4*>(busPtr))->SetBrightness(b); break;
-      case I_8266_U1_NEO_4: (static_cast<B_8266_U1_NEO_4*>(busPtr))->SetBrightness(b); break;
-      case I_8266_DM_NEO_4: (static_cast<B_8266_DM_NEO_4*>(busPtr))->SetBrightness(b); break;
-      case I_8266_BB_NEO_4: (static_cast<B_8266_BB_NEO_4*>(busPtr))->SetBrightness(b); break;
-      case I_8266_U0_400_3: (static_cast<B_8266_U0_400_3*>(busPtr))->SetBrightness(b); break;
-      case I_8266_U1_400_3: (static_cast<B_8266_U1_400_3*>(busPtr))->SetBrightness(b); break;
-      case I_8266_DM_400_3: (static_cast<B_8266_DM_400_3*>(busPtr))->SetBrightness(b); break;
-      case I_8266_BB_400_3: (static_cast<B_8266_BB_400_3*>(busPtr))->SetBrightness(b); break;
-      case I_8266_U0_TM1_4: (static_cast<B_8266_U0_TM1_4*>(busPtr))->SetBrightness(b); break;
-      case I_8266_U1_TM1_4: (static_cast<B_8266_U1_TM1_4*>(busPtr))->SetBrightness(b); break;
-      case I_8266_DM_TM1_4: (static_cast<B_8266_DM_TM1_4*>(busPtr))->SetBrightness(b); break;
-      case I_8266_BB_TM1_4: (static_cast<B_8266_BB_TM1_4*>(busPtr))->SetBrightness(b); break;
-    #endif
-    #ifdef ARDUINO_ARCH_ESP32
-      case I_32_RN_NEO_3: (static_cast<B_32_RN_NEO_3*>(busPtr))->SetBrightness(b); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_3: (static_cast<B_32_I0_NEO_3*>(busPtr))->SetBrightness(b); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_3: (static_cast<B_32_I1_NEO_3*>(busPtr))->SetBrightness(b); break;
-      #endif
-      case I_32_RN_NEO_4: (static_cast<B_32_RN_NEO_4*>(busPtr))->SetBrightness(b); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_4: (static_cast<B_32_I0_NEO_4*>(busPtr))->SetBrightness(b); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_4: (static_cast<B_32_I1_NEO_4*>(busPtr))->SetBrightness(b); break;
-      #endif
-      case I_32_RN_400_3: (static_cast<B_32_RN_400_3*>(busPtr))->SetBrightness(b); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_400_3: (static_cast<B_32_I0_400_3*>(busPtr))->SetBrightness(b); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_400_3: (static_cast<B_32_I1_400_3*>(busPtr))->SetBrightness(b); break;
-      #endif
-      case I_32_RN_TM1_4: (static_cast<B_32_RN_TM1_4*>(busPtr))->SetBrightness(b); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_TM1_4: (static_cast<B_32_I0_TM1_4*>(busPtr))->SetBrightness(b); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_TM1_4: (static_cast<B_32_I1_TM1_4*>(busPtr))->SetBrightness(b); break;
-      #endif
-    #endif
-      case I_HS_DOT_3: (static_cast<B_HS_DOT_3*>(busPtr))->SetBrightness(b); break;
-      case I_SS_DOT_3: (static_cast<B_SS_DOT_3*>(busPtr))->SetBrightness(b); break;
-      case I_HS_LPD_3: (static_cast<B_HS_LPD_3*>(busPtr))->SetBrightness(b); break;
-      case I_SS_LPD_3: (static_cast<B_SS_LPD_3*>(busPtr))->SetBrightness(b); break;
-      case I_HS_LPO_3: (static_cast<B_HS_LPO_3*>(busPtr))->SetBrightness(b); break;
-      case I_SS_LPO_3: (static_cast<B_SS_LPO_3*>(busPtr))->SetBrightness(b); break;
-      case I_HS_WS1_3: (static_cast<B_HS_WS1_3*>(busPtr))->SetBrightness(b); break;
-      case I_SS_WS1_3: (static_cast<B_SS_WS1_3*>(busPtr))->SetBrightness(b); break;
-      case I_HS_P98_3: (static_cast<B_HS_P98_3*>(busPtr))->SetBrightness(b); break;
-      case I_SS_P98_3: (static_cast<B_SS_P98_3*>(busPtr))->SetBrightness(b); break;
+    memset(&_trans, 0, sizeof(_trans));
+    _trans.length = _frameLen * 8; //in bits
+    _trans.tx_buffer = _frame;
+    _busy = (spi_device_queue_trans(_spi, &_trans, 0) == ESP_OK);
+  }
+
+  bool canShow() {
+    waitDone(0);
+    //WS2801 latches after the clock was idle for 500us
+    return !_busy && (_type != I_32_DS_WS1_3 || micros() - _doneAt > 500);
+  }
+
+  void setBrightness(uint8_t b) { _bri = b; }
+  void setPixelColor(uint16_t pix, uint32_t c) { if (pix < _len) _pixels[pix] = c; }
+  uint32_t getPixelColor(uint16_t pix) { return (pix < _len) ? _pixels[pix] : 0; }
+
+  void encode(const uint32_t* data, uint16_t pix, uint16_t count, const uint8_t* shifts, bool dither = false) {
+    for (uint16_t i = 0; i < count; i++) _pixels[pix + i] = toWireOrder(data[i], shifts);
+  }
+
+  private:
+  SpiDmaDriver(uint8_t busType, uint16_t len, uint8_t hostIdx) : _type(busType), _len(len), _hostIdx(hostIdx) {} //the host is reserved by create()
+
+  bool init(spi_host_device_t host, uint8_t* pins) {
+    uint8_t pixBytes = 3;
+    uint16_t endLen = 0;
+    uint32_t khz = 0;
+    switch (_type) {
+      case I_32_DS_DOT_3: pixBytes = 4; _startLen = 4; endLen = 4 + (_len + 15) / 16; khz = WLED_SPI_KHZ_APA102;  break;
+      case I_32_DS_LPD_3: _startLen = endLen = (_len + 31) / 32;                       khz = WLED_SPI_KHZ_LPD8806; break;
+      case I_32_DS_LPO_3: pixBytes = 2; _startLen = 4; endLen = (_len + 7) / 8;        khz = WLED_SPI_KHZ_LPD6803; break;
+      case I_32_DS_WS1_3:                                                              khz = WLED_SPI_KHZ_WS2801;  break;
+      case I_32_DS_P98_3: pixBytes = 4; _startLen = endLen = 4;                        khz = WLED_SPI_KHZ_P9813;   break;
+      default: return false;
     }
-  };
-  static uint32_t getPixelColor(void* busPtr, uint8_t busType, uint16_t pix, uint8_t co) {
-    RgbwColor col(0,0,0,0); 
-    switch (busType) {
-      case I_NONE: break;
-    #ifdef ESP8266
-      case I_8266_U0_NEO_3: col = (static_cast<B_8266_U0_NEO_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_U1_NEO_3: col = (static_cast<B_8266_U1_NEO_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_DM_NEO_3: col = (static_cast<B_8266_DM_NEO_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_BB_NEO_3: col = (static_cast<B_8266_BB_NEO_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_U0_NEO_4: col = (static_cast<B_8266_U0_NEO_4*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_U1_NEO_4: col = (static_cast<B_8266_U1_NEO_4*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_DM_NEO_4: col = (static_cast<B_8266_DM_NEO_4*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_BB_NEO_4: col = (static_cast<B_8266_BB_NEO_4*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_U0_400_3: col = (static_cast<B_8266_U0_400_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_U1_400_3: col = (static_cast<B_8266_U1_400_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_DM_400_3: col = (static_cast<B_8266_DM_400_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_BB_400_3: col = (static_cast<B_8266_BB_400_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_U0_TM1_4: col = (static_cast<B_8266_U0_TM1_4*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_U1_TM1_4: col = (static_cast<B_8266_U1_TM1_4*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_DM_TM1_4: col = (static_cast<B_8266_DM_TM1_4*>(busPtr))->GetPixelColor(pix); break;
-      case I_8266_BB_TM1_4: col = (static_cast<B_8266_BB_TM1_4*>(busPtr))->GetPixelColor(pix); break;
-    #endif
-    #ifdef ARDUINO_ARCH_ESP32
-      case I_32_RN_NEO_3: col = (static_cast<B_32_RN_NEO_3*>(busPtr))->GetPixelColor(pix); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_3: col = (static_cast<B_32_I0_NEO_3*>(busPtr))->GetPixelColor(pix); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_3: col = (static_cast<B_32_I1_NEO_3*>(busPtr))->GetPixelColor(pix); break;
-      #endif
-      case I_32_RN_NEO_4: col = (static_cast<B_32_RN_NEO_4*>(busPtr))->GetPixelColor(pix); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_4: col = (static_cast<B_32_I0_NEO_4*>(busPtr))->GetPixelColor(pix); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_4: col = (static_cast<B_32_I1_NEO_4*>(busPtr))->GetPixelColor(pix); break;
-      #endif
-      case I_32_RN_400_3: col = (static_cast<B_32_RN_400_3*>(busPtr))->GetPixelColor(pix); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_400_3: col = (static_cast<B_32_I0_400_3*>(busPtr))->GetPixelColor(pix); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_400_3: col = (static_cast<B_32_I1_400_3*>(busPtr))->GetPixelColor(pix); break;
-      #endif
-      case I_32_RN_TM1_4: col = (static_cast<B_32_RN_TM1_4*>(busPtr))->GetPixelColor(pix); break;
-      #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_TM1_4: col = (static_cast<B_32_I0_TM1_4*>(busPtr))->GetPixelColor(pix); break;
-      #endif
-      #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_TM1_4: col = (static_cast<B_32_I1_TM1_4*>(busPtr))->GetPixelColor(pix); break;
-      #endif
+    _frameLen = _startLen + _len * pixBytes + endLen;
+    _frame = (uint8_t*)heap_caps_calloc(_frameLen, 1, MALLOC_CAP_DMA); //start and end frames stay zero
+    _pixels = (uint32_t*)calloc(_len, sizeof(uint32_t));
+    if (!_frame || !_pixels) return false;
+
+    spi_bus_config_t buscfg;
+    memset(&buscfg, 0, sizeof(buscfg));
+    buscfg.mosi_io_num = pins[0];
+    buscfg.miso_io_num = -1;
+    buscfg.sclk_io_num = pins[1];
+    buscfg.quadwp_io_num = -1;
+    buscfg.quadhd_io_num = -1;
+    buscfg.max_transfer_sz = _frameLen;
+    #if ESP_IDF_VERSION_MAJOR >= 4
+    if (spi_bus_initialize(host, &buscfg, SPI_DMA_CH_AUTO) != ESP_OK) return false;
+    #else
+    if (spi_bus_initialize(host, &buscfg, _hostIdx + 1) != ESP_OK) return false; //DMA channel 1 or 2
     #endif
-      case I_HS_DOT_3: col = (static_cast<B_HS_DOT_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_SS_DOT_3: col = (static_cast<B_SS_DOT_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_HS_LPD_3: col = (static_cast<B_HS_LPD_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_SS_LPD_3: col = (static_cast<B_SS_LPD_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_HS_LPO_3: col = (static_cast<B_HS_LPO_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_SS_LPO_3: col = (static_cast<B_SS_LPO_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_HS_WS1_3: col = (static_cast<B_HS_WS1_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_SS_WS1_3: col = (static_cast<B_SS_WS1_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_HS_P98_3: col = (static_cast<B_HS_P98_3*>(busPtr))->GetPixelColor(pix); break;
-      case I_SS_P98_3: col = (static_cast<B_SS_P98_3*>(busPtr))->GetPixelColor(pix); break;
+
+    spi_device_interface_config_t devcfg;
+    memset(&devcfg, 0, sizeof(devcfg));
+    devcfg.mode = 0;
+    devcfg.clock_speed_hz = khz * 1000;
+    devcfg.spics_io_num = -1;
+    devcfg.queue_size = 1;
+    if (spi_bus_add_device(host, &devcfg, &_spi) != ESP_OK) {
+      _spi = nullptr;
+      spi_bus_free(host);
+      return false;
     }
-    
-    #ifdef COLOR_ORDER_OVERRIDE
-    if (pix >= COO_MIN && pix < COO_MAX) co = COO_ORDER;
-    #endif
+    _host = host;
+    return true;
+  }
 
-    switch (co)
-    {
-      //                    W               G              R               B
-      case  0: return ((col.W << 24) | (col.G << 8) | (col.R << 16) | (col.B)); //0 = GRB, default
-      case  1: return ((col.W << 24) | (col.R << 8) | (col.G << 16) | (col.B)); //1 = RGB, common for WS2811
-      case  2: return ((col.W << 24) | (col.B << 8) | (col.R << 16) | (col.G)); //2 = BRG
-      case  3: return ((col.W << 24) | (col.B << 8) | (col.G << 16) | (col.R)); //3 = RBG
-      case  4: return ((col.W << 24) | (col.R << 8) | (col.B << 16) | (col.G)); //4 = BGR
-      case  5: return ((col.W << 24) | (col.G << 8) | (col.B << 16) | (col.R)); //5 = GBR
+  void waitDone(TickType_t ticks) {
+    if (!_busy) return;
+    spi_transaction_t* t;
+    if (spi_device_get_trans_result(_spi, &t, ticks) == ESP_OK) {
+      _busy = false;
+      _doneAt = micros();
     }
-    return 0;
   }
 
-  static void cleanup(void* busPtr, uint8_t busType) {
-    if (busPtr == nullptr) return;
+  uint8_t  _type;
+  uint16_t _len;
+  uint8_t  _bri = 255;
+  uint32_t* _pixels = nullptr;  //wire order colors without brightness
+  uint8_t* _frame = nullptr;    //DMA buffer with the encoded frame
+  uint16_t _frameLen = 0;
+  uint16_t _startLen = 0;
+  spi_host_device_t _host;
+  uint8_t  _hostIdx = 0;
+  spi_device_handle_t _spi = nullptr;
+  spi_transaction_t _trans;
+  bool     _busy = false;
+  uint32_t _doneAt = 0;
+};
+#endif
+
+//creates the driver matching the internal bus type (I_XX_XXX_X above)
+class PolyBus {
+  public:
+  static PolyDriver* create(uint8_t busType, uint8_t* pins, uint16_t len, uint8_t channel) {
+    PolyDriver* drv = nullptr;
     switch (busType) {
       case I_NONE: break;
     #ifdef ESP8266
-      case I_8266_U0_NEO_3: delete (static_cast<B_8266_U0_NEO_3*>(busPtr)); break;
-      case I_8266_U1_NEO_3: delete (static_cast<B_8266_U1_NEO_3*>(busPtr)); break;
-      case I_8266_DM_NEO_3: delete (static_cast<B_8266_DM_NEO_3*>(busPtr)); break;
-      case I_8266_BB_NEO_3: delete (static_cast<B_8266_BB_NEO_3*>(busPtr)); break;
-      case I_8266_U0_NEO_4: delete (static_cast<B_8266_U0_NEO_4*>(busPtr)); break;
-      case I_8266_U1_NEO_4: delete (static_cast<B_8266_U1_NEO_4*>(busPtr)); break;
-      case I_8266_DM_NEO_4: delete (static_cast<B_8266_DM_NEO_4*>(busPtr)); break;
-      case I_8266_BB_NEO_4: delete (static_cast<B_8266_BB_NEO_4*>(busPtr)); break;
-      case I_8266_U0_400_3: delete (static_cast<B_8266_U0_400_3*>(busPtr)); break;
-      case I_8266_U1_400_3: delete (static_cast<B_8266_U1_400_3*>(busPtr)); break;
-      case I_8266_DM_400_3: delete (static_cast<B_8266_DM_400_3*>(busPtr)); break;
-      case I_8266_BB_400_3: delete (static_cast<B_8266_BB_400_3*>(busPtr)); break;
-      case I_8266_U0_TM1_4: delete (static_cast<B_8266_U0_TM1_4*>(busPtr)); break;
-      case I_8266_U1_TM1_4: delete (static_cast<B_8266_U1_TM1_4*>(busPtr)); break;
-      case I_8266_DM_TM1_4: delete (static_cast<B_8266_DM_TM1_4*>(busPtr)); break;
-      case I_8266_BB_TM1_4: delete (static_cast<B_8266_BB_TM1_4*>(busPtr)); break;
+      case I_8266_U0_NEO_3: drv = new B_8266_U0_NEO_3(len, pins[0]); break;
+      case I_8266_U1_NEO_3: drv = new B_8266_U1_NEO_3(len, pins[0]); break;
+      case I_8266_DM_NEO_3: drv = new B_8266_DM_NEO_3(len, pins[0]); break;
+      case I_8266_BB_NEO_3: drv = new B_8266_BB_NEO_3(len, pins[0]); break;
+      case I_8266_U0_NEO_4: drv = new B_8266_U0_NEO_4(len, pins[0]); break;
+      case I_8266_U1_NEO_4: drv = new B_8266_U1_NEO_4(len, pins[0]); break;
+      case I_8266_DM_NEO_4: drv = new B_8266_DM_NEO_4(len, pins[0]); break;
+      case I_8266_BB_NEO_4: drv = new B_8266_BB_NEO_4(len, pins[0]); break;
+      case I_8266_U0_400_3: drv = new B_8266_U0_400_3(len, pins[0]); break;
+      case I_8266_U1_400_3: drv = new B_8266_U1_400_3(len, pins[0]); break;
+      case I_8266_DM_400_3: drv = new B_8266_DM_400_3(len, pins[0]); break;
+      case I_8266_BB_400_3: drv = new B_8266_BB_400_3(len, pins[0]); break;
+      case I_8266_U0_TM1_4: drv = new B_8266_U0_TM1_4(len, pins[0]); break;
+      case I_8266_U1_TM1_4: drv = new B_8266_U1_TM1_4(len, pins[0]); break;
+      case I_8266_DM_TM1_4: drv = new B_8266_DM_TM1_4(len, pins[0]); break;
+      case I_8266_BB_TM1_4: drv = new B_8266_BB_TM1_4(len, pins[0]); break;
     #endif
     #ifdef ARDUINO_ARCH_ESP32
-      case I_32_RN_NEO_3: delete (static_cast<B_32_RN_NEO_3*>(busPtr)); break;
+      case I_32_RN_NEO_3: drv = new B_32_RN_NEO_3(len, pins[0], (NeoBusChannel)channel); break;
       #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_3: delete (static_cast<B_32_I0_NEO_3*>(busPtr)); break;
+      case I_32_I0_NEO_3: drv = new B_32_I0_NEO_3(len, pins[0]); break;
       #endif
       #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_3: delete (static_cast<B_32_I1_NEO_3*>(busPtr)); break;
+      case I_32_I1_NEO_3: drv = new B_32_I1_NEO_3(len, pins[0]); break;
       #endif
-      case I_32_RN_NEO_4: delete (static_cast<B_32_RN_NEO_4*>(busPtr)); break;
+      case I_32_RN_NEO_4: drv = new B_32_RN_NEO_4(len, pins[0], (NeoBusChannel)channel); break;
       #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_NEO_4: delete (static_cast<B_32_I0_NEO_4*>(busPtr)); break;
+      case I_32_I0_NEO_4: drv = new B_32_I0_NEO_4(len, pins[0]); break;
       #endif
       #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_NEO_4: delete (static_cast<B_32_I1_NEO_4*>(busPtr)); break;
+      case I_32_I1_NEO_4: drv = new B_32_I1_NEO_4(len, pins[0]); break;
       #endif
-      case I_32_RN_400_3: delete (static_cast<B_32_RN_400_3*>(busPtr)); break;
+      case I_32_RN_400_3: drv = new B_32_RN_400_3(len, pins[0], (NeoBusChannel)channel); break;
       #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_400_3: delete (static_cast<B_32_I0_400_3*>(busPtr)); break;
+      case I_32_I0_400_3: drv = new B_32_I0_400_3(len, pins[0]); break;
       #endif
       #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_400_3: delete (static_cast<B_32_I1_400_3*>(busPtr)); break;
+      case I_32_I1_400_3: drv = new B_32_I1_400_3(len, pins[0]); break;
       #endif
-      case I_32_RN_TM1_4: delete (static_cast<B_32_RN_TM1_4*>(busPtr)); break;
+      case I_32_RN_TM1_4: drv = new B_32_RN_TM1_4(len, pins[0], (NeoBusChannel)channel); break;
       #ifndef CONFIG_IDF_TARGET_ESP32C3
-      case I_32_I0_TM1_4: delete (static_cast<B_32_I0_TM1_4*>(busPtr)); break;
+      case I_32_I0_TM1_4: drv = new B_32_I0_TM1_4(len, pins[0]); break;
       #endif
       #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
-      case I_32_I1_TM1_4: delete (static_cast<B_32_I1_TM1_4*>(busPtr)); break;
+      case I_32_I1_TM1_4: drv = new B_32_I1_TM1_4(len, pins[0]); break;
+      #endif
+      //DMA SPI while an SPI host is free, software SPI after that
+      case I_32_DS_DOT_3: drv = SpiDmaDriver::create(busType, pins, len); if (!drv) drv = new B_SS_DOT_3(len, pins[1], pins[0]); break;
+      case I_32_DS_LPD_3: drv = SpiDmaDriver::create(busType, pins, len); if (!drv) drv = new B_SS_LPD_3(len, pins[1], pins[0]); break;
+      case I_32_DS_LPO_3: drv = SpiDmaDriver::create(busType, pins, len); if (!drv) drv = new B_SS_LPO_3(len, pins[1], pins[0]); break;
+      case I_32_DS_WS1_3: drv = SpiDmaDriver::create(busType, pins, len); if (!drv) drv = new B_SS_WS1_3(len, pins[1], pins[0]); break;
+      case I_32_DS_P98_3: drv = SpiDmaDriver::create(busType, pins, len); if (!drv) drv = new B_SS_P98_3(len, pins[1], pins[0]); break;
+      #ifdef WLED_USE_PARALLEL_I2S
+      case I_32_PX_NEO_3: drv = new B_32_PX_NEO_3(len, pins[0]); break;
+      case I_32_PX_NEO_4: drv = new B_32_PX_NEO_4(len, pins[0]); break;
+      case I_32_PX_400_3: drv = new B_32_PX_400_3(len, pins[0]); break;
+      case I_32_PX_TM1_4: drv = new B_32_PX_TM1_4(len, pins[0]); break;
       #endif
     #endif
-      case I_HS_DOT_3: delete (static_cast<B_HS_DOT_3*>(busPtr)); break;
-      case I_SS_DOT_3: delete (static_cast<B_SS_DOT_3*>(busPtr)); break;
-      case I_HS_LPD_3: delete (static_cast<B_HS_LPD_3*>(busPtr)); break;
-      case I_SS_LPD_3: delete (static_cast<B_SS_LPD_3*>(busPtr)); break;
-      case I_HS_LPO_3: delete (static_cast<B_HS_LPO_3*>(busPtr)); break;
-      case I_SS_LPO_3: delete (static_cast<B_SS_LPO_3*>(busPtr)); break;
-      case I_HS_WS1_3: delete (static_cast<B_HS_WS1_3*>(busPtr)); break;
-      case I_SS_WS1_3: delete (static_cast<B_SS_WS1_3*>(busPtr)); break;
-      case I_HS_P98_3: delete (static_cast<B_HS_P98_3*>(busPtr)); break;
-      case I_SS_P98_3: delete (static_cast<B_SS_P98_3*>(busPtr)); break;
+      // for 2-wire: pins[1] is clk, pins[0] is dat.  begin expects (len, clk, dat)
+      case I_HS_DOT_3: drv = new B_HS_DOT_3(len, pins[1], pins[0]); break;
+      case I_SS_DOT_3: drv = new B_SS_DOT_3(len, pins[1], pins[0]); break;
+      case I_HS_LPD_3: drv = new B_HS_LPD_3(len, pins[1], pins[0]); break;
+      case I_SS_LPD_3: drv = new B_SS_LPD_3(len, pins[1], pins[0]); break;
+      case I_HS_LPO_3: drv = new B_HS_LPO_3(len, pins[1], pins[0]); break;
+      case I_SS_LPO_3: drv = new B_SS_LPO_3(len, pins[1], pins[0]); break;
+      case I_HS_WS1_3: drv = new B_HS_WS1_3(len, pins[1], pins[0]); break;
+      case I_SS_WS1_3: drv = new B_SS_WS1_3(len, pins[1], pins[0]); break;
+      case I_HS_P98_3: drv = new B_HS_P98_3(len, pins[1], pins[0]); break;
+      case I_SS_P98_3: drv = new B_SS_P98_3(len, pins[1], pins[0]); break;
     }
-  }
+    if (drv) drv->begin(pins);
+    return drv;
+  };
 
   //gives back the internal type index (I_XX_XXX_X above) for the input 
   static uint8_t getI(uint8_t busType, uint8_t* pins, uint8_t num = 0) {
     if (!IS_DIGITAL(busType)) return I_NONE;
     if (IS_2PIN(busType)) { //SPI LED chips
-      bool isHSPI = false;
-      #ifdef ESP8266
-      if (pins[0] == P_8266_HS_MOSI && pins[1] == P_8266_HS_CLK) isHSPI = true;
+      #ifdef ARDUINO_ARCH_ESP32
+      switch (busType) { //PolyBus::create() falls back to software SPI once all SPI hosts are taken
+        case TYPE_APA102:  return I_32_DS_DOT_3;
+        case TYPE_LPD8806: return I_32_DS_LPD_3;
+        case TYPE_LPD6803: return I_32_DS_LPO_3;
+        case TYPE_WS2801:  return I_32_DS_WS1_3;
+        case TYPE_P9813:   return I_32_DS_P98_3;
+      }
+      return I_NONE;
       #else
-        if(!num) isHSPI = true; // temporary hack to limit use of hardware SPI to a single SPI peripheral: only allow ESP32 hardware serial on segment 0
-      #endif
+      bool isHSPI = (pins[0] == P_8266_HS_MOSI && pins[1] == P_8266_HS_CLK);
       uint8_t t = I_NONE;
       switch (busType) {
         case TYPE_APA102:  t = I_SS_DOT_3; break;
@@ -749,6 +632,7 @@ class PolyBus {
       }
       if (t > I_NONE && isHSPI) t--; //hardware SPI has one smaller ID than software
       return t;
+      #endif
     } else {
       #ifdef ESP8266
       uint8_t offset = pins[0] -1; //for driver: 0 = uart0, 1 = uart1, 2 = dma, 3 = bitbang
@@ -764,6 +648,20 @@ class PolyBus {
         case TYPE_TM1814:
           return I_8266_U0_TM1_4 + offset;
       }
+      #elif defined(WLED_USE_PARALLEL_I2S)
+      //each bus is one lane of I2S1, the transfer starts once all lanes have been shown
+      if (num > 15) return I_NONE;
+      switch (busType) {
+        case TYPE_WS2812_RGB:
+        case TYPE_WS2812_WWA:
+          return I_32_PX_NEO_3;
+        case TYPE_SK6812_RGBW:
+          return I_32_PX_NEO_4;
+        case TYPE_WS2811_400KHZ:
+          return I_32_PX_400_3;
+        case TYPE_TM1814:
+          return I_32_PX_TM1_4;
+      }
       #else //ESP32
       uint8_t offset = 0; //0 = RMT (num 0-7) 8 = I2S0 9 = I2S1
       #ifndef CONFIG_IDF_TARGET_ESP32S2
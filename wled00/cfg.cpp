@@ -87,6 +87,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   CJSON(cctFromRgb, hw_led[F("cr")]);
   CJSON(strip.cctBlending, hw_led[F("cb")]);
   Bus::setCCTBlend(strip.cctBlending);
+  Bus::setDitherEnabled(hw_led[F("dith")] | Bus::isDitherEnabled());
   strip.setTargetFps(hw_led["fps"]); //NOP if 0, default 42 FPS
 
   JsonArray ins = hw_led["ins"];
@@ -117,13 +118,15 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
       bool reversed = elm["rev"];
       bool refresh = elm["ref"] | false;
       ledType |= refresh << 7; // hack bit 7 to indicate strip requires off refresh
+      uint8_t fps = elm["fps"] | 0; // own refresh rate limit of the bus
+      uint32_t startChannel = elm["ch"] | 0; // network busses: DDP start channel, E1.31/Art-Net first universe
       if (fromFS) {
-        BusConfig bc = BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst);
+        BusConfig bc = BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst, fps, startChannel);
         mem += BusManager::memUsage(bc);
         if (mem <= MAX_LED_MEMORY && busses.getNumBusses() <= WLED_MAX_BUSSES) busses.add(bc);  // finalization will be done in WLED::beginStrip()
       } else {
         if (busConfigs[s] != nullptr) delete busConfigs[s];
-        busConfigs[s] = new BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst);
+        busConfigs[s] = new BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst, fps, startChannel);
         busesChanged = true;
       }
       s++;
@@ -301,6 +304,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   JsonObject if_live_dmx = if_live[F("dmx")];
   CJSON(e131Universe, if_live_dmx[F("uni")]);
   CJSON(e131SkipOutOfSequence, if_live_dmx[F("seqskip")]);
+  CJSON(e131SendSync, if_live_dmx[F("osync")]);
   CJSON(DMXAddress, if_live_dmx[F("addr")]);
   CJSON(DMXMode, if_live_dmx["mode"]);
 
@@ -586,6 +590,7 @@ void serializeConfig() {
   hw_led[F("cb")] = strip.cctBlending;
   hw_led["fps"] = strip.getTargetFps();
   hw_led[F("rgbwm")] = strip.autoWhiteMode;
+  hw_led[F("dith")] = Bus::isDitherEnabled();
 
   JsonArray hw_led_ins = hw_led.createNestedArray("ins");
 
@@ -604,6 +609,8 @@ void serializeConfig() {
     ins[F("skip")] = bus->skippedLeds();
     ins["type"] = bus->getType() & 0x7F;
     ins["ref"] = bus->isOffRefreshRequired();
+    ins["fps"] = bus->getTargetFps();
+    if (IS_NETWORK(bus->getType())) ins["ch"] = bus->getStartChannel();
     //ins[F("rgbw")] = bus->isRgbw();
   }
 
@@ -714,6 +721,7 @@ void serializeConfig() {
   JsonObject if_live_dmx = if_live.createNestedObject("dmx");
   if_live_dmx[F("uni")] = e131Universe;
   if_live_dmx[F("seqskip")] = e131SkipOutOfSequence;
+  if_live_dmx[F("osync")] = e131SendSync;
   if_live_dmx[F("addr")] = DMXAddress;
   if_live_dmx["mode"] = DMXMode;
 
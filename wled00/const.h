@@ -19,11 +19,27 @@
   #endif
 #endif
 
+//temporal dithering of dimmed output needs a byte per channel and LED plus the bus pixel buffer, compiled out on ESP8266 unless asked for
+//where compiled in, it is still off until enabled in cfg.json (hw.led.dith)
+#if defined(ESP8266) && !defined(WLED_ENABLE_DITHERING)
+  #define WLED_DISABLE_DITHERING
+#endif
+#ifndef WLED_DITHER_MIN_FPS
+  #define WLED_DITHER_MIN_FPS 40
+#endif
+
+//parallel I2S output is only available on the original ESP32
+#if defined(WLED_USE_PARALLEL_I2S) && (defined(ESP8266) || defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32C3))
+  #undef WLED_USE_PARALLEL_I2S
+#endif
+
 #ifndef WLED_MAX_BUSSES
   #ifdef ESP8266
     #define WLED_MAX_BUSSES 3
   #else
-    #ifdef CONFIG_IDF_TARGET_ESP32S2
+    #if defined(WLED_USE_PARALLEL_I2S)
+      #define WLED_MAX_BUSSES 16
+    #elif defined(CONFIG_IDF_TARGET_ESP32S2)
       #define WLED_MAX_BUSSES 5
     #else
       #define WLED_MAX_BUSSES 10
@@ -170,11 +186,15 @@
 #define TYPE_NET_DDP_RGB         80            //network DDP RGB bus (master broadcast bus)
 #define TYPE_NET_E131_RGB        81            //network E131 RGB bus (master broadcast bus)
 #define TYPE_NET_ARTNET_RGB      82            //network ArtNet RGB bus (master broadcast bus)
+#define TYPE_NET_DDP_RGBW        88            //network DDP RGBW bus (master broadcast bus)
+#define TYPE_NET_E131_RGBW       89            //network E131 RGBW bus (master broadcast bus)
+#define TYPE_NET_ARTNET_RGBW     90            //network ArtNet RGBW bus (master broadcast bus)
 
 #define IS_DIGITAL(t) ((t) & 0x10) //digital are 16-31 and 48-63
 #define IS_PWM(t)     ((t) > 40 && (t) < 46)
 #define NUM_PWM_PINS(t) ((t) - 40) //for analog PWM 41-45 only
 #define IS_2PIN(t)      ((t) > 47)
+#define IS_NETWORK(t)   ((t) >= TYPE_NET_DDP_RGB && (t) < 96) //virtual network busses
 
 //Color orders
 #define COL_ORDER_GRB             0           //GRB(w),defaut
@@ -241,6 +261,7 @@
 // WLED Error modes
 #define ERR_NONE         0  // All good :)
 #define ERR_EEP_COMMIT   2  // Could not commit to EEPROM (wrong flash layout?)
+#define ERR_NORAM        8  // Effect RAM depleted, the effect change was rejected
 #define ERR_JSON         9  // JSON parsing failed (input too large?)
 #define ERR_FS_BEGIN    10  // Could not init filesystem (no partition?)
 #define ERR_FS_QUOTA    11  // The FS is full or the maximum file size is reached
@@ -288,13 +309,59 @@
 #define SETTINGS_STACK_BUF_SIZE 3096 
 #endif
 
-#ifdef WLED_USE_ETHERNET
-  #define E131_MAX_UNIVERSE_COUNT 20
-#else
+// upper limit only, the universe state is allocated for the configured LED count and DMX mode
+#ifndef E131_MAX_UNIVERSE_COUNT
+  #define E131_MAX_UNIVERSE_COUNT ((MAX_LEDS + 127) / 128 + 1) // MAX_LEDS in RGBW mode, +1 if the DMX start address is not 1
+#endif
+
+// synchronization universe of E1.31 output (network busses)
+#ifndef E131_OUT_SYNC_UNIVERSE
+  #define E131_OUT_SYNC_UNIVERSE 63999
+#endif
+
+// serial receive buffer, 1.5 Mbaud Adalight delivers 150 bytes per ms
+#ifndef WLED_SERIAL_RX_BUFFER
+  #ifdef ESP8266
+    #define WLED_SERIAL_RX_BUFFER 1024
+  #else
+    #define WLED_SERIAL_RX_BUFFER 2048
+  #endif
+#endif
+
+// UDP notifier/realtime packets handled per loop iteration at most, and the time after which draining stops early
+#ifndef UDP_MAX_PACKETS_PER_LOOP
+  #define UDP_MAX_PACKETS_PER_LOOP 16
+#endif
+#ifndef UDP_DRAIN_BUDGET_US
+  #define UDP_DRAIN_BUDGET_US 5000
+#endif
+
+// compressed live LED stream (see live_leds.h), maximum message size
+#ifndef LIVE_LEDS_MSG_SIZE
+  #ifdef ESP8266
+    #define LIVE_LEDS_MSG_SIZE 1024
+  #else
+    #define LIVE_LEDS_MSG_SIZE 4096
+  #endif
+#endif
+
+// realtime packets are queued by the network task and applied in the main loop (0 to handle them in the network task)
+// on ESP8266 only packets arriving before the last complete frame was shown are queued
+// the queues are allocated when the interfaces are initialized, the E1.31 one is sized for the universes the LEDs span
+// (see e131QueueSize()) and follows LED count changes
+#ifndef E131_QUEUE_FRAMES
+  #ifdef ESP8266
+    #define E131_QUEUE_FRAMES 1 // frames of all universes and a sync packet
+  #else
+    #define E131_QUEUE_FRAMES 2 // drained every loop
+  #endif
+#endif
+#define E131_QUEUE_ENTRY 648 // a full universe in the queue (638 byte E1.31 packet + header)
+#ifndef DDP_QUEUE_SIZE
   #ifdef ESP8266
-    #define E131_MAX_UNIVERSE_COUNT 9
+    #define DDP_QUEUE_SIZE (2*1472) // 2 full packets
   #else
-    #define E131_MAX_UNIVERSE_COUNT 12
+    #define DDP_QUEUE_SIZE 8192
   #endif
 #endif
 
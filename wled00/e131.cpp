@@ -4,48 +4,326 @@
 #define MAX_4_CH_LEDS_PER_UNIVERSE 128
 #define MAX_CHANNELS_PER_UNIVERSE 512
 
+#define E131_SYNC_TIMEOUT   2500 // E1.31: fall back to unsynchronized output if no sync packet arrives for this long [ms]
+#define ARTNET_SYNC_TIMEOUT 4000 // Art-Net: same for OpSync [ms]
+#define E131_FRAME_TIMEOUT   100 // show an incomplete frame if no further universe arrives for this long [ms]
+
+#define E131_UNI_RECEIVED 0x01
+#define E131_UNI_EXPECTED 0x02
+
+// copy of e131UniverseSeen for the web server task, e131AllocUniverses() may free the original any time
+static unsigned long e131UniverseSeenCopy[E131_MAX_UNIVERSE_COUNT] = {0};
+static uint16_t e131UniversesCopied = 0;
+
+static byte ddpLastSequenceNumber = 0;
+static unsigned long ddpFrameStartedAt = 0; // micros() of the first packet after the last push
+static volatile bool ddpShowPending = false; // a pushed DDP frame waits for its timecode, the queues hold the next one back
+static unsigned long ddpShowAt = 0;          // millis() to show it at
+
 /*
  * E1.31 handler
  */
 
-//DDP protocol support, called by handleE131Packet
-//handles RGB data only
-void handleDDPPacket(e131_packet_t* p) {
-  int lastPushSeq = e131LastSequenceNumber[0];
-  
-  //reject late packets belonging to previous frame (assuming 4 packets max. before push)
-  if (e131SkipOutOfSequence && lastPushSeq) {
-    int sn = p->sequenceNum & 0xF;
-    if (sn) {
-      if (lastPushSeq > 5) {
-        if (sn > (lastPushSeq -5) && sn < lastPushSeq) return;
-      } else {
-        if (sn > (10 + lastPushSeq) || sn < lastPushSeq) return;
-      }
+// number of consecutive universes the configured LEDs span in the current DMX mode
+uint16_t e131NeededUniverses()
+{
+  uint16_t totalLen = strip.getLengthTotal();
+  uint16_t n = 1;
+  if (DMXMode >= DMX_MODE_MULTIPLE_RGB) {
+    const uint16_t dmxChannelsPerLed = (DMXMode == DMX_MODE_MULTIPLE_RGBW) ? 4 : 3;
+    const uint16_t ledsPerUniverse = (DMXMode == DMX_MODE_MULTIPLE_RGBW) ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
+    uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
+    uint16_t ledsInFirstUniverse = ((MAX_CHANNELS_PER_UNIVERSE - DMXAddress + 1) - dimmerOffset) / dmxChannelsPerLed;
+    if (totalLen > ledsInFirstUniverse) n += (totalLen - ledsInFirstUniverse + ledsPerUniverse - 1) / ledsPerUniverse;
+  }
+  return min(n, (uint16_t)E131_MAX_UNIVERSE_COUNT);
+}
+
+// queue size for frames of n universes and a sync packet, as far as the free heap allows
+size_t e131QueueSize(uint16_t n)
+{
+  size_t size = ((n + 1) * E131_QUEUE_FRAMES + 1) * E131_QUEUE_ENTRY; // one entry spare, the ring skips the space left at its end
+  size_t heap = ESP.getFreeHeap() + e131.queueSize(); // the current queue is freed first
+  size_t avail = (heap > MIN_HEAP_SIZE) ? (heap - MIN_HEAP_SIZE) / 2 : 0; // leave at least half for everything else
+  if (size > avail) size = avail - avail % E131_QUEUE_ENTRY;
+  return size; // 0: packets are handled in the network task
+}
+
+// (re)allocates the per universe state when LED count or DMX mode changed
+static bool e131AllocUniverses()
+{
+  uint16_t n = e131NeededUniverses();
+  if (n == e131Universes && e131UniverseSeen) return true;
+  free(e131UniverseSeen);
+  e131UniverseSeen = (unsigned long*)calloc(n, sizeof(unsigned long) + 2); // last seen times, sequence numbers, frame flags
+  if (!e131UniverseSeen) {
+    e131Universes = 0;
+    e131LastSequenceNumber = e131FrameFlags = nullptr;
+    return false;
+  }
+  e131Universes = n;
+  e131LastSequenceNumber = (byte*)(e131UniverseSeen + n);
+  e131FrameFlags = e131LastSequenceNumber + n;
+  e131FrameUniverses = e131FrameExpected = e131ExpectedUniverses = 0;
+  return true;
+}
+
+/*
+ * Frame assembly
+ * Universes are collected in e131FrameFlags and shown together: on the sync packet if the
+ * sender uses E1.31 synchronization or Art-Net OpSync, otherwise once all expected universes are in.
+ * The expected set is learned from the sender: a universe arriving twice ends the frame.
+ */
+bool e131SyncActive()
+{
+  unsigned long timeout = (realtimeMode == REALTIME_MODE_ARTNET) ? ARTNET_SYNC_TIMEOUT : E131_SYNC_TIMEOUT;
+  if (realtimeMode != REALTIME_MODE_ARTNET && !e131SyncAddress) return false;
+  return e131LastSync && millis() - e131LastSync < timeout;
+}
+
+static void e131ClearFrame()
+{
+  for (uint16_t i = 0; i < e131Universes; i++) e131FrameFlags[i] &= ~E131_UNI_RECEIVED;
+  e131FrameUniverses = e131FrameExpected = 0;
+}
+
+// shows a complete frame before the next packet can change it: right away when packets are
+// handled from the main loop, otherwise handleNotifications() shows it and the receive queues
+// hold back packets until then
+static void realtimeFrameReady()
+{
+  if (e131.isDraining() || ddp.isDraining()) {
+    showRealtimeFrame();
+    return;
+  }
+  e131NewData = true;
+  e131.pause();
+  ddp.pause();
+}
+
+static void e131ShowFrame()
+{
+  if (!e131FrameUniverses) return;
+  e131ClearFrame();
+  e131FrameReadyAt = e131FrameStartedAt;
+  realtimeFramesReceived++;
+  realtimeFrameReady();
+}
+
+// before the universe data is applied: a universe received twice means the sender started over,
+// the frame is complete as it is
+static void e131StartUniverse(uint16_t idx)
+{
+  if (!(e131FrameFlags[idx] & E131_UNI_RECEIVED)) return;
+  if (!e131SyncActive()) { // learn the set of universes it sends
+    for (uint16_t i = 0; i < e131Universes; i++) {
+      if (e131FrameFlags[i] & E131_UNI_RECEIVED) e131FrameFlags[i] |= E131_UNI_EXPECTED;
+      else                                       e131FrameFlags[i] &= ~E131_UNI_EXPECTED;
+    }
+    e131ExpectedUniverses = e131FrameUniverses;
+    e131ShowFrame();
+  }
+  e131ClearFrame();
+}
+
+// after the universe data is applied
+static void e131AddUniverse(uint16_t idx)
+{
+  if (!e131FrameUniverses) e131FrameStartedAt = micros();
+  e131FrameFlags[idx] |= E131_UNI_RECEIVED;
+  e131FrameUniverses++;
+  if (e131FrameFlags[idx] & E131_UNI_EXPECTED) e131FrameExpected++;
+  e131LastUniverseAt = millis();
+  if (!e131SyncActive() && e131ExpectedUniverses && e131FrameExpected == e131ExpectedUniverses) e131ShowFrame();
+}
+
+static void e131HandleSync(uint16_t address)
+{
+  if (realtimeMode != REALTIME_MODE_E131 && realtimeMode != REALTIME_MODE_ARTNET) return;
+  if (realtimeMode == REALTIME_MODE_E131 && (!e131SyncAddress || address != e131SyncAddress)) return;
+  e131LastSync = millis();
+  e131ShowFrame();
+}
+
+// called from handleNotifications(): shows DDP frames scheduled by timecode, doesn't wait forever for universes
+// that got lost, updates the packet rates and the multicast groups
+void handleE131Frames()
+{
+  uint16_t n = e131UniverseSeen ? e131Universes : 0;
+  if (n) memcpy(e131UniverseSeenCopy, e131UniverseSeen, n * sizeof(unsigned long));
+  e131UniversesCopied = n;
+
+  static unsigned long lastRateUpdate = 0;
+  static uint32_t lastPackets[3] = {0};
+  if (millis() - lastRateUpdate >= 1000) {
+    for (uint8_t i = 0; i < 3; i++) {
+      realtimePacketRate[i] = realtimePackets[i] - lastPackets[i];
+      lastPackets[i] = realtimePackets[i];
+    }
+    lastRateUpdate = millis();
+    // the universe count follows the LED configuration, the sync universe is learned from the sender
+    static uint16_t queuedUniverses = 0;
+    uint16_t needed = e131NeededUniverses();
+    if (e131Multicast && interfacesInited) e131.joinUniverses(e131Universe, needed, e131SyncAddress);
+    if (interfacesInited && needed != queuedUniverses) {
+      e131.setQueueSize(e131QueueSize(needed));
+      queuedUniverses = needed;
     }
   }
 
-  uint32_t start = htonl(p->channelOffset) /3;
-  start += DMXAddress /3;
-  uint16_t stop = start + htons(p->dataLen) /3;
-  uint8_t* data = p->data;
-  uint16_t c = 0;
-  if (p->flags & DDP_TIMECODE_FLAG) c = 4; //packet has timecode flag, we do not support it, but data starts 4 bytes later
+  if (ddpShowPending && (long)(millis() - ddpShowAt) >= 0) {
+    ddpShowPending = false;
+    e131NewData = true; // the queues resume once it is shown
+  }
+  if (!e131FrameUniverses || e131NewData || e131SyncActive()) return;
+  if (millis() - e131LastUniverseAt > E131_FRAME_TIMEOUT) e131ShowFrame();
+}
 
+// ms since each universe was last received, -1 if never
+void serializeUniverseAges(JsonArray uage)
+{
+  unsigned long now = millis();
+  uint16_t n = e131UniversesCopied;
+  for (uint16_t i = 0; i < n; i++) {
+    unsigned long seen = e131UniverseSeenCopy[i];
+    if (seen) uage.add(now - seen);
+    else      uage.add(-1);
+  }
+}
+
+/*
+ * DDP handler
+ */
+
+#define DDP_SCHEDULE_MAX 1000 // show frames with timecodes further ahead than this right away [ms]
+
+// replies to status and config queries (JSON as per the DDP spec)
+static void ddpReply(e131_packet_t* p, IPAddress clientIP)
+{
+  static uint8_t reply[DDP_HEADER_LEN + 256];
+  char* json = (char*)reply + DDP_HEADER_LEN;
+  int len;
+  if (p->destination == DDP_ID_STATUS) {
+    len = snprintf_P(json, 256, PSTR("{\"status\":{\"man\":\"WLED\",\"mod\":\"%s\",\"ver\":\"%s\",\"mac\":\"%s\",\"push\":true,\"ntp\":%s}}"),
+      serverDescription, versionString, escapedMac.c_str(), (toki.getTimeSource() >= TOKI_TS_MS) ? "true" : "false");
+  } else if (p->destination == DDP_ID_CONFIG) {
+    IPAddress ip = Network.localIP(), nm = Network.subnetMask(), gw = Network.gatewayIP();
+    len = snprintf_P(json, 256, PSTR("{\"config\":{\"ip\":\"%u.%u.%u.%u\",\"nm\":\"%u.%u.%u.%u\",\"gw\":\"%u.%u.%u.%u\",\"ports\":[{\"port\":0,\"ts\":0,\"l\":%u,\"ss\":0}]}}"),
+      ip[0], ip[1], ip[2], ip[3], nm[0], nm[1], nm[2], nm[3], gw[0], gw[1], gw[2], gw[3], strip.getLengthTotal());
+  } else return;
+  if (len < 0 || len >= 256) return;
+
+  reply[0] = DDP_FLAGS_VER1 | DDP_REPLY_FLAG | DDP_PUSH_FLAG;
+  reply[1] = p->sequenceNum;
+  reply[2] = 0;
+  reply[3] = p->destination;
+  memset(reply + 4, 0, 4); // offset
+  reply[8] = len >> 8;
+  reply[9] = len & 0xFF;
+  ddp.writeTo(reply, DDP_HEADER_LEN + len, clientIP, DDP_DEFAULT_PORT);
+}
+
+// ms until a DDP timecode (middle 32 bits of NTP time) is due, 0 if it is due or can't be used
+static uint32_t ddpTimecodeAhead(uint32_t timeCode)
+{
+  if (toki.getTimeSource() < TOKI_TS_MS) return 0; // needs a ms accurate clock, i.e. NTP
+  Toki::Time t = toki.getTime();
+  uint32_t now = ((t.sec + YEARS_70) << 16) | (((uint32_t)t.ms << 16) / 1000);
+  int32_t ahead = timeCode - now;
+  if (ahead <= 0) return 0;
+  uint32_t ms = ((uint32_t)ahead * 1000ULL) >> 16;
+  return (ms > DDP_SCHEDULE_MAX) ? 0 : ms;
+}
+
+// true if a packet with sequence number sn belongs to an already pushed frame
+static bool ddpIsLate(uint8_t sn)
+{
+  static uint8_t newest = 0; // sequence numbers run 1..15, 0 means unused
+  if (!sn) return false;
+  if (!newest || !ddpLastSequenceNumber) {
+    newest = sn;
+    return false;
+  }
+  uint8_t behindPush   = (ddpLastSequenceNumber + 15 - sn) % 15;
+  uint8_t behindNewest = (newest + 15 - sn) % 15;
+  if (behindPush < 7 && behindNewest < 8) return true; // behind both the last push and the newest packet (half the sequence space)
+  newest = sn;
+  return false;
+}
+
+//DDP protocol support, called by handleE131Packet
+//handles RGB and RGBW data with 8 or 16 bits per channel
+void handleDDPPacket(e131_packet_t* p, IPAddress clientIP) {
+  if (p->flags & DDP_QUERY_FLAG) {
+    ddpReply(p, clientIP);
+    return;
+  }
+  if (p->flags & DDP_REPLY_FLAG) return;
+  if (p->destination != DDP_ID_DISPLAY && p->destination != DDP_ID_ALL && p->destination != 0) return; // JSON control, DMX or custom IDs
+
+  //reject late packets belonging to previous frame
+  if (e131SkipOutOfSequence && ddpIsLate(p->sequenceNum & 0xF)) {
+    realtimeSeqDropped++;
+    return;
+  }
+  if (!ddpFrameStartedAt) ddpFrameStartedAt = micros();
+
+  uint8_t channels, bytesPerChannel;
+  switch (p->dataType) {
+    case 0: case 1: // undefined/legacy, sent as RGB by most implementations
+    case DDP_TYPE_RGB24:  channels = 3; bytesPerChannel = 1; break;
+    case DDP_TYPE_RGB48:  channels = 3; bytesPerChannel = 2; break;
+    case DDP_TYPE_RGBW32: channels = 4; bytesPerChannel = 1; break;
+    case DDP_TYPE_RGBW64: channels = 4; bytesPerChannel = 2; break;
+    default: return; // HSL, grayscale and other sizes are not supported
+  }
+  const uint8_t bpp = channels * bytesPerChannel;
+
+  uint8_t* data = (p->flags & DDP_TIMECODE_FLAG) ? p->tc_data : p->data;
+  uint32_t offset = htonl(p->channelOffset); // in bytes
+  uint16_t len = htons(p->dataLen);
+  uint16_t maxLen = sizeof(p->raw) - (data - p->raw);
+  if (len > maxLen) len = maxLen;
+
+  // a packet may start in the middle of a pixel, skip to the next full one
+  uint8_t skip = (bpp - offset % bpp) % bpp;
+  if (len < skip) skip = len;
+  data += skip;
+  len -= skip;
+  uint32_t start = (offset + skip) / bpp + DMXAddress /3;
+  uint16_t count = len / bpp;
+
+  realtimeIP = clientIP;
   realtimeLock(realtimeTimeoutMs, REALTIME_MODE_DDP);
-  
-  if (!realtimeOverride) {
-    for (uint16_t i = start; i < stop; i++) {
-      setRealtimePixel(i, data[c], data[c+1], data[c+2], 0);
-      c+=3;
+
+  if (!realtimeOverride && count && start < strip.getLengthTotal()) {
+    if (bytesPerChannel == 2) { // 16 bit to 8 bit in place, rounded
+      for (uint16_t i = 0; i < count * channels; i++) {
+        uint32_t v = ((data[2*i] << 8) | data[2*i+1]) + 128;
+        data[i] = (v - (v >> 8)) >> 8;
+      }
     }
+    setRealtimePixels(start, data, count, channels == 4);
   }
 
-  bool push = p->flags & DDP_PUSH_FLAG;
-  if (push) {
-    e131NewData = true;
+  if (p->flags & DDP_PUSH_FLAG) {
+    e131FrameReadyAt = ddpFrameStartedAt;
+    ddpFrameStartedAt = 0;
+    realtimeFramesReceived++;
+    // a single frame waits for its timecode: the queues keep the packets of the next one until it is shown,
+    // without a queue they would overwrite it, so it is shown right away
+    uint32_t ahead = (p->flags & DDP_TIMECODE_FLAG) && ddp.isQueued() ? ddpTimecodeAhead(htonl(p->timeCode)) : 0;
+    if (ahead) {
+      ddpShowAt = millis() + ahead;
+      ddpShowPending = true;
+      e131FrameReadyAt = 0; // the wait is on purpose, it is not show latency
+      e131.pause();
+      ddp.pause();
+    } else {
+      realtimeFrameReady();
+    }
     byte sn = p->sequenceNum & 0xF;
-    if (sn) e131LastSequenceNumber[0] = sn;
+    if (sn) ddpLastSequenceNumber = sn;
   }
 }
 
@@ -56,21 +334,30 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
   uint8_t* e131_data = nullptr;
   uint8_t seq = 0, mde = REALTIME_MODE_E131;
 
+  if (protocol <= P_DDP) realtimePackets[protocol]++;
+
   if (protocol == P_ARTNET)
   {
+    if (p->art_opcode == ARTNET_OPCODE_OPSYNC) {
+      e131HandleSync(0);
+      return;
+    }
     uni = p->art_universe;
     dmxChannels = htons(p->art_length);
     e131_data = p->art_data;
     seq = p->art_sequence_number;
     mde = REALTIME_MODE_ARTNET;
   } else if (protocol == P_E131) {
+    if (htonl(p->root_vector) != 4) { // synchronization packet
+      e131HandleSync(htons(p->syn_address));
+      return;
+    }
     uni = htons(p->universe);
     dmxChannels = htons(p->property_value_count) -1;
     e131_data = p->property_values;
     seq = p->sequence_number;
   } else { //DDP
-    realtimeIP = clientIP;
-    handleDDPPacket(p);
+    handleDDPPacket(p, clientIP);
     return;
   }
 
@@ -84,9 +371,10 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
   #endif
 
   // only listen for universes we're handling & allocated memory
-  if (uni >= (e131Universe + E131_MAX_UNIVERSE_COUNT)) return;
+  if (!e131AllocUniverses()) return;
+  if (uni < e131Universe || uni >= (e131Universe + e131Universes)) return;
 
-  uint8_t previousUniverses = uni - e131Universe;
+  uint16_t previousUniverses = uni - e131Universe;
 
   if (e131SkipOutOfSequence)
     if (seq < e131LastSequenceNumber[uni-e131Universe] && seq > 20 && e131LastSequenceNumber[uni-e131Universe] < 250){
@@ -97,9 +385,12 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
       DEBUG_PRINT(", universe=");
       DEBUG_PRINT(uni);
       DEBUG_PRINTLN(")");
+      realtimeSeqDropped++;
       return;
     }
   e131LastSequenceNumber[uni-e131Universe] = seq;
+  e131UniverseSeen[uni-e131Universe] = millis() | 1; // 0 means never
+  if (protocol == P_E131) e131SyncAddress = htons(p->sync_address);
 
   // update status info
   realtimeIP = clientIP;
@@ -113,6 +404,8 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
     dataOffset--;
   }
 
+  e131StartUniverse(previousUniverses);
+
   switch (DMXMode) {
     case DMX_MODE_DISABLED:
       return;  // nothing to do
@@ -204,17 +497,7 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
           previousLeds = ledsInFirstUniverse + (previousUniverses - 1) * ledsPerUniverse;
           ledsTotal = previousLeds + (dmxChannels / dmxChannelsPerLed);
         }
-        if (!is4Chan) {
-          for (uint16_t i = previousLeds; i < ledsTotal; i++) {
-            setRealtimePixel(i, e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], 0);
-            dmxOffset+=3;
-          }
-        } else {
-          for (uint16_t i = previousLeds; i < ledsTotal; i++) {
-            setRealtimePixel(i, e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], e131_data[dmxOffset+3]);
-            dmxOffset+=4;
-          }
-        }
+        if (ledsTotal > previousLeds) setRealtimePixels(previousLeds, e131_data + dmxOffset, ledsTotal - previousLeds, is4Chan);
         break;
       }
     default:
@@ -223,5 +506,5 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
       break;
   }
 
-  e131NewData = true;
+  e131AddUniverse(previousUniverses);
 }
@@ -80,6 +80,11 @@ void handleDMX();
 
 //e131.cpp
 void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol);
+void handleE131Frames();
+void serializeUniverseAges(JsonArray uage);
+uint16_t e131NeededUniverses();
+size_t e131QueueSize(uint16_t n);
+bool e131SyncActive();
 
 //file.cpp
 bool handleFileRead(AsyncWebServerRequest*, String path);
@@ -133,6 +138,7 @@ bool deserializeState(JsonObject root, byte callMode = CALL_MODE_DIRECT_CHANGE,
 void serializeSegment(JsonObject& root, WS2812FX::Segment& seg, byte id, bool forPreset = false, bool segmentBounds = true);
 void serializeState(JsonObject root, bool forPreset = false, bool includeBri = true, bool segmentBounds = true);
 void serializeInfo(JsonObject root);
+void serializeRealtimeStats(JsonObject rt);
 void serveJson(AsyncWebServerRequest* request);
 #ifdef WLED_ENABLE_JSONLIVE
 bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient = 0);
@@ -204,11 +210,13 @@ bool updateVal(const String* req, const char* key, byte* val, byte minv=0, byte
 
 //udp.cpp
 void notify(byte callMode, bool followUp=false);
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, byte *buffer, uint8_t bri=255, bool isRGBW=false);
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, byte *buffer, uint8_t bri=255, bool isRGBW=false, uint32_t startChannel=0);
 void realtimeLock(uint32_t timeoutMs, byte md = REALTIME_MODE_GENERIC);
 void exitRealtime();
+void showRealtimeFrame();
 void handleNotifications();
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w);
+void setRealtimePixels(uint16_t i, const uint8_t* data, uint16_t count, bool rgbw = false);
 void refreshNodeList();
 void sendSysInfoUDP();
 
@@ -222,6 +230,7 @@ void sendSysInfoUDP();
 bool requestJSONBufferLock(uint8_t module=255);
 void releaseJSONBufferLock();
 uint8_t extractModeName(uint8_t mode, const char *src, char *dest, uint8_t maxLen);
+void readBusPixelColors(uint16_t first, uint32_t* colors, uint16_t count);
 
 //um_manager.cpp
 class Usermod {
@@ -91,11 +91,18 @@ byte relativeChange(byte property, int8_t amount, byte lowerBoundary, byte highe
 void changeEffect(uint8_t fx)
 {
   if (irApplyToAllSelected) {
+    strip.startSegmentDataPlan(); // the effect is applied to all selected segments or none
+    for (uint8_t i = 0; i < strip.getMaxSegments(); i++) {
+      WS2812FX::Segment& seg = strip.getSegment(i);
+      if (seg.isActive() && seg.isSelected()) strip.planSegment(i, fx, seg.virtualLength());
+    }
+    if (!strip.acceptSegmentDataPlan()) errorFlag = ERR_NORAM;
     for (uint8_t i = 0; i < strip.getMaxSegments(); i++) {
       WS2812FX::Segment& seg = strip.getSegment(i);
       if (!seg.isActive() || !seg.isSelected()) continue;
       strip.setMode(i, fx);
     }
+    strip.endSegmentDataPlan();
     setValuesFromFirstSelectedSeg();
   } else {
     strip.setMode(strip.getMainSegmentId(), fx);
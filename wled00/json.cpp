@@ -21,6 +21,48 @@ bool getVal(JsonVariant elem, byte* val, byte vmin=0, byte vmax=255) {
   return false; //key does not exist
 }
 
+// adds the effect and length segment elem will have to the segment data plan, mirrors deserializeSegment()
+static void planSegment(JsonObject elem, byte it)
+{
+  byte id = elem["id"] | it;
+  if (id >= strip.getMaxSegments()) return;
+
+  WS2812FX::Segment seg = strip.getSegment(id); //copy, only used for the planned length
+  uint16_t start = elem["start"] | seg.start;
+  int stop = elem["stop"] | -1;
+  if (stop < 0) {
+    uint16_t len = elem["len"];
+    stop = (len > 0) ? start + len : seg.stop;
+  }
+  if (stop > strip.getLengthTotal()) stop = strip.getLengthTotal();
+
+  JsonVariant fxVar = elem["fx"];
+  uint8_t fx = fxVar.is<int>() ? fxVar.as<int>() : seg.mode; //random and inc/dec are checked when applied
+
+  seg.grouping = elem["grp"] | seg.grouping;
+  seg.spacing  = elem[F("spc")] | seg.spacing;
+  if (!seg.grouping) seg.grouping = 1;
+  if (elem[F("mi")] | seg.getOption(SEG_OPTION_MIRROR)) seg.options |=  MIRROR;
+  else                                                   seg.options &= ~MIRROR;
+
+  bool repeat = elem["rpt"] | false;
+  if (repeat && stop > 0) { //copies to the following segments, see deserializeSegment()
+    uint16_t len = stop - start;
+    for (byte i=id+1; i<strip.getMaxSegments(); i++) {
+      start = start + len;
+      if (start >= strip.getLengthTotal()) break;
+      seg.start = start;
+      seg.stop  = start + len;
+      strip.planSegment(i, fx, seg.virtualLength());
+    }
+    return;
+  }
+
+  seg.start = start;
+  seg.stop  = stop;
+  strip.planSegment(id, fx, seg.isActive() ? seg.virtualLength() : 0);
+}
+
 void deserializeSegment(JsonObject elem, byte it, byte presetId)
 {
   byte id = elem["id"] | it;
@@ -165,7 +207,8 @@ void deserializeSegment(JsonObject elem, byte it, byte presetId)
   byte fx = seg.mode;
   if (getVal(elem["fx"], &fx, 1, strip.getModeCount())) { //load effect ('r' random, '~' inc/dec, 1-255 exact value)
     if (!presetId && currentPlaylist>=0) unloadPlaylist();
-    strip.setMode(id, fx);
+    // reject effects whose declared data would not fit instead of silently falling back to solid
+    if (!strip.setMode(id, fx)) errorFlag = ERR_NORAM;
   }
 
   //getVal also supports inc/decrementing and random
@@ -322,6 +365,23 @@ bool deserializeState(JsonObject root, byte callMode, byte presetId)
 
   int it = 0;
   JsonVariant segVar = root["seg"];
+  //plan the effect data of all segments in the request before applying any of them
+  strip.startSegmentDataPlan();
+  if (segVar.is<JsonObject>())
+  {
+    int id = segVar["id"] | -1;
+    bool didPlan = false;
+    for (byte s = 0; id < 0 && s < strip.getMaxSegments(); s++) {
+      WS2812FX::Segment &sg = strip.getSegment(s);
+      if (sg.isActive() && sg.isSelected()) { planSegment(segVar, s); didPlan = true; }
+    }
+    if (!didPlan) planSegment(segVar, (id < 0) ? strip.getMainSegmentId() : id);
+  } else {
+    for (JsonObject elem : segVar.as<JsonArray>()) planSegment(elem, it++);
+    it = 0;
+  }
+  strip.acceptSegmentDataPlan();
+
   if (segVar.is<JsonObject>())
   {
     int id = segVar["id"] | -1;
@@ -351,6 +411,7 @@ bool deserializeState(JsonObject root, byte callMode, byte presetId)
       it++;
     }
   }
+  strip.endSegmentDataPlan();
 
   usermods.readFromJsonState(root);
 
@@ -511,6 +572,26 @@ int getSignalQuality(int rssi)
     return quality;
 }
 
+// realtime ingest statistics, part of info and sent to WebSocket clients subscribed with {"rt":true}
+void serializeRealtimeStats(JsonObject rt)
+{
+  JsonArray pps = rt.createNestedArray(F("pps")); // packets/s: E1.31, Art-Net, DDP
+  JsonArray pkts = rt.createNestedArray(F("pkts"));
+  for (uint8_t i = 0; i < 3; i++) {
+    pps.add(realtimePacketRate[i]);
+    pkts.add(realtimePackets[i]);
+  }
+  rt[F("seqdrop")] = realtimeSeqDropped;                        // skipped out of sequence
+  rt[F("qdrop")]   = e131.droppedPackets() + ddp.droppedPackets(); // receive queue full (ESP32)
+  rt[F("rx")]      = realtimeFramesReceived;                    // complete frames received
+  rt[F("frames")]  = e131FramesShown;                           // frames shown
+  rt[F("lat")]     = e131ShowLatency;                           // first packet to show of the last frame [us]
+  rt[F("latavg")]  = e131ShowLatencyAvg;
+  rt[F("sync")]    = e131SyncActive();                          // frames are shown on E1.31 sync / Art-Net OpSync packets
+
+  serializeUniverseAges(rt.createNestedArray(F("uage")));
+}
+
 void serializeInfo(JsonObject root)
 {
   root[F("ver")] = versionString;
@@ -524,6 +605,8 @@ void serializeInfo(JsonObject root)
   leds["fps"] = strip.getFps();
   leds[F("maxpwr")] = (strip.currentMilliamps)? strip.ablMilliampsMax : 0;
   leds[F("maxseg")] = strip.getMaxSegments();
+  leds[F("fxdata")] = strip.getUsedSegmentData(); // bytes of effect data in use
+  leds[F("fxdmax")] = MAX_SEGMENT_DATA;
   //leds[F("seglock")] = false; //might be used in the future to prevent modifications to segment config
   
   uint8_t totalLC = 0;
@@ -568,6 +651,9 @@ void serializeInfo(JsonObject root)
     root[F("lip")] = realtimeIP.toString();
   }
 
+  JsonObject rt = root.createNestedObject("rt");
+  serializeRealtimeStats(rt);
+
   #ifdef WLED_ENABLE_WEBSOCKETS
   root[F("ws")] = ws.count();
   #else
@@ -823,6 +909,19 @@ void serializeNodes(JsonObject root)
   }
 }
 
+// relative CPU cost of each effect and the effect data it needs on the main segment
+void serializeModeMeta(JsonObject root)
+{
+  uint16_t len = strip.getMainSegment().virtualLength();
+  JsonArray cost = root.createNestedArray(F("cost"));
+  JsonArray mem  = root.createNestedArray(F("mem"));
+  for (uint8_t m = 0; m < strip.getModeCount(); m++) {
+    cost.add(strip.getModeCost(m));
+    mem.add(strip.getModeDataSize(m, len));
+  }
+  root[F("free")] = MAX_SEGMENT_DATA - strip.getUsedSegmentData();
+}
+
 void serveJson(AsyncWebServerRequest* request)
 {
   byte subJson = 0;
@@ -832,6 +931,7 @@ void serveJson(AsyncWebServerRequest* request)
   else if (url.indexOf("si")    > 0) subJson = 3;
   else if (url.indexOf("nodes") > 0) subJson = 4;
   else if (url.indexOf("palx")  > 0) subJson = 5;
+  else if (url.indexOf("fxmeta") > 0) subJson = 6;
   #ifdef WLED_ENABLE_JSONLIVE
   else if (url.indexOf("live")  > 0) {
     serveLiveLeds(request);
@@ -873,6 +973,8 @@ void serveJson(AsyncWebServerRequest* request)
       serializeNodes(lDoc); break;
     case 5: //palettes
       serializePalettes(lDoc, request); break;
+    case 6: //effect cost and memory hints
+      serializeModeMeta(lDoc); break;
     default: //all
       JsonObject state = lDoc.createNestedObject("state");
       serializeState(state);
@@ -31,6 +31,12 @@ void applyValuesToSelectedSegs()
   // copy of first selected segment to tell if value was updated
   uint8_t firstSel = strip.getFirstSelectedSegId();
   WS2812FX::Segment selsegPrev = strip.getSegment(firstSel);
+  strip.startSegmentDataPlan(); // a new effect is applied to all selected segments or none
+  for (uint8_t i = 0; effectCurrent != selsegPrev.mode && i < strip.getMaxSegments(); i++) {
+    WS2812FX::Segment& seg = strip.getSegment(i);
+    if (i == firstSel || (seg.isActive() && seg.isSelected())) strip.planSegment(i, effectCurrent, seg.virtualLength());
+  }
+  if (effectCurrent != selsegPrev.mode && !strip.acceptSegmentDataPlan()) errorFlag = ERR_NORAM;
   for (uint8_t i = 0; i < strip.getMaxSegments(); i++) {
     WS2812FX::Segment& seg = strip.getSegment(i);
     if (i != firstSel && (!seg.isActive() || !seg.isSelected())) continue;
@@ -38,12 +44,14 @@ void applyValuesToSelectedSegs()
     if (effectSpeed     != selsegPrev.speed)     {seg.speed     = effectSpeed;     stateChanged = true;}
     if (effectIntensity != selsegPrev.intensity) {seg.intensity = effectIntensity; stateChanged = true;}
     if (effectPalette   != selsegPrev.palette)   {seg.palette   = effectPalette;   stateChanged = true;}
-    if (effectCurrent   != selsegPrev.mode)      {strip.setMode(i, effectCurrent); stateChanged = true;}
+    if (effectCurrent   != selsegPrev.mode && strip.setMode(i, effectCurrent)) stateChanged = true;
     uint32_t col0 = RGBW32(   col[0],    col[1],    col[2],    col[3]);
     uint32_t col1 = RGBW32(colSec[0], colSec[1], colSec[2], colSec[3]);
     if (col0 != selsegPrev.colors[0])            {seg.setColor(0, col0, i);        stateChanged = true;}
     if (col1 != selsegPrev.colors[1])            {seg.setColor(1, col1, i);        stateChanged = true;}
   }
+  strip.endSegmentDataPlan();
+  effectCurrent = strip.getSegment(firstSel).mode; //the effect may have been rejected for lack of segment data
 }
 
 
@@ -0,0 +1,74 @@
+#include "live_leds.h"
+
+/*
+ * Compressed live LED stream, see live_leds.h for the format
+ */
+
+void writeLiveLedsHeader(uint8_t* dest, bool rgbw, bool reset, uint8_t bri, uint16_t total, uint16_t first, uint16_t count)
+{
+  dest[0] = 'L';
+  dest[1] = 2; //version
+  dest[2] = rgbw | (reset << 1);
+  dest[3] = bri;
+  dest[4] = total >> 8; dest[5] = total & 0xFF;
+  dest[6] = first >> 8; dest[7] = first & 0xFF;
+  dest[8] = count >> 8; dest[9] = count & 0xFF;
+}
+
+static inline void putLiveLedsColor(uint8_t* dest, uint32_t c, bool rgbw)
+{
+  dest[0] = c >> 16; dest[1] = c >> 8; dest[2] = c;
+  if (rgbw) dest[3] = c >> 24;
+}
+
+uint16_t encodeLiveLeds(uint8_t* dest, uint16_t maxLen, uint16_t &pix, uint16_t end, uint32_t* prev, bool rgbw, live_leds_read_function read)
+{
+  const uint8_t bpp = rgbw ? 4 : 3;
+  uint32_t col[LIVE_LEDS_READ_CHUNK];
+  uint16_t pos = 0;
+  uint16_t rec = 0;   //position of the control byte of the open record
+  uint8_t recType = 0, recLen = 0; //open record: 0 none, 1 unchanged, 2 repeat, 3 literal
+  uint32_t last = 0;  //color of the previous pixel if it was sent
+
+  while (pix < end) {
+    uint16_t n = end - pix;
+    if (n > LIVE_LEDS_READ_CHUNK) n = LIVE_LEDS_READ_CHUNK;
+    read(pix, col, n);
+    for (uint16_t i = 0; i < n; i++) {
+      uint32_t c = col[i];
+      if (prev && prev[pix] == c) {
+        if (recType == 1 && recLen < 128) {
+          dest[rec]++;
+        } else {
+          if (pos + 1 > maxLen) return pos;
+          rec = pos; dest[pos++] = 0;
+          recType = 1; recLen = 0;
+        }
+      } else if (recType == 2 && c == last && recLen < 64) {
+        dest[rec]++;
+      } else if (recType == 3 && c == last) {
+        //turn the last literal color and this pixel into a repeat record
+        if (recLen > 1 && pos + 1 > maxLen) return pos;
+        if (recLen == 1) pos = rec;
+        else { dest[rec]--; pos -= bpp; }
+        rec = pos; dest[pos++] = 0x81;
+        putLiveLedsColor(dest + pos, c, rgbw); pos += bpp;
+        recType = 2; recLen = 1;
+      } else if (recType == 3 && recLen < 64) {
+        if (pos + bpp > maxLen) return pos;
+        dest[rec]++;
+        putLiveLedsColor(dest + pos, c, rgbw); pos += bpp;
+      } else {
+        if (pos + 1 + bpp > maxLen) return pos;
+        rec = pos; dest[pos++] = 0xC0;
+        putLiveLedsColor(dest + pos, c, rgbw); pos += bpp;
+        recType = 3; recLen = 0;
+      }
+      recLen++;
+      if (prev) prev[pix] = c;
+      last = c;
+      pix++;
+    }
+  }
+  return pos;
+}
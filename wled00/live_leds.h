@@ -0,0 +1,33 @@
+#ifndef LiveLeds_h
+#define LiveLeds_h
+
+/*
+ * Compressed live LED stream ("L" version 2), shared by the WebSocket and serial readback.
+ * Has no strip or bus dependencies (host tested, see test/), the pixels are read through a function.
+ *
+ * A message starts with a 10 byte header:
+ *   'L', 2, flags (bit 0: 4 bytes per pixel RGBW, else RGB; bit 1: stream start, all pixels are black before it), brightness,
+ *   total pixel count, first pixel, pixel count of this message (16 bit big endian each)
+ * followed by records, each a control byte c:
+ *   0x00-0x7F: the next c+1 pixels are unchanged since they were last sent
+ *   0x80-0xBF: the next (c&0x3F)+1 pixels all have the one color that follows
+ *   0xC0-0xFF: (c&0x3F)+1 colors follow, one per pixel
+ * Pixels are in bus order at full resolution, colors are not scaled by brightness.
+ */
+
+#include <stdint.h>
+
+#define LIVE_LEDS_HEADER_LEN 10
+#define LIVE_LEDS_READ_CHUNK 64 // pixels read at once
+
+// reads count pixel colors (WRGB) starting at pixel first into colors
+typedef void (*live_leds_read_function)(uint16_t first, uint32_t* colors, uint16_t count);
+
+void writeLiveLedsHeader(uint8_t* dest, bool rgbw, bool reset, uint8_t bri, uint16_t total, uint16_t first, uint16_t count);
+
+// encodes the pixels from pix up to end as records into dest, stops early when maxLen is reached
+// prev holds the colors last sent for each pixel and is updated, pass nullptr for a full frame
+// advances pix past the encoded pixels and returns the number of bytes written
+uint16_t encodeLiveLeds(uint8_t* dest, uint16_t maxLen, uint16_t &pix, uint16_t end, uint32_t* prev, bool rgbw, live_leds_read_function read);
+
+#endif
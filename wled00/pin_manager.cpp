@@ -240,6 +240,19 @@ void PinManagerClass::deallocateLedc(byte pos, byte channels)
     bitWrite(ledcAlloc[by], bi, false);
   }
 }
+
+bool PinManagerClass::allocateSpiHost(byte host, PinOwner tag)
+{
+  if (host > 1 || tag == PinOwner::None || spiHostOwner[host] != PinOwner::None) return false;
+  spiHostOwner[host] = tag;
+  return true;
+}
+
+void PinManagerClass::deallocateSpiHost(byte host, PinOwner tag)
+{
+  if (host > 1 || spiHostOwner[host] != tag) return;
+  spiHostOwner[host] = PinOwner::None;
+}
 #endif
 
 PinManagerClass pinManager = PinManagerClass();
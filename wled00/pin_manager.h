@@ -66,6 +66,7 @@ class PinManagerClass {
   #else
   uint8_t pinAlloc[5] = {0x00, 0x00, 0x00, 0x00, 0x00}; //40bit, 1 bit per pin, we use all bits
   uint8_t ledcAlloc[2] = {0x00, 0x00}; //16 LEDC channels
+  PinOwner spiHostOwner[2] = { PinOwner::None }; //general purpose SPI hosts
   PinOwner ownerTag[40] = { PinOwner::None };
   #endif
   uint8_t i2cAllocCount = 0; // allow multiple allocation of I2C bus pins but keep track of allocations
@@ -103,6 +104,9 @@ class PinManagerClass {
   #ifdef ARDUINO_ARCH_ESP32
   byte allocateLedc(byte channels);
   void deallocateLedc(byte pos, byte channels);
+  // general purpose SPI hosts (0: SPI2/HSPI, 1: SPI3/VSPI), reserve one before initializing it with the ESP-IDF or SPIClass
+  bool allocateSpiHost(byte host, PinOwner tag);
+  void deallocateSpiHost(byte host, PinOwner tag);
   #endif
 };
 
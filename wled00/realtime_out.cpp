@@ -0,0 +1,145 @@
+#include <string.h>
+#include "realtime_out.h"
+#include "bus_color.h"
+
+/*
+ * Packet building for the DDP, E1.31 and Art-Net output of network busses
+ */
+
+static const uint8_t acnPacketId[12] = { 0x41, 0x53, 0x43, 0x2d, 0x45, 0x31, 0x2e, 0x31, 0x37, 0x00, 0x00, 0x00 };
+static const char artnetId[8] = "Art-Net"; // including the terminating 0
+
+static void putU16(uint8_t* p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xFF; }
+
+uint16_t ddpBuildHeader(uint8_t* p, uint8_t seq, bool push, bool rgbw, uint32_t offset, uint16_t channels)
+{
+  p[0] = push ? (DDP_FLAGS_VER1 | DDP_PUSH_FLAG) : DDP_FLAGS_VER1;
+  p[1] = seq;
+  p[2] = rgbw ? DDP_TYPE_RGBW32 : DDP_TYPE_RGB24;
+  p[3] = DDP_ID_DISPLAY;
+  // data offset in bytes, 32-bit number, MSB first
+  p[4] = 0xFF & (offset >> 24);
+  p[5] = 0xFF & (offset >> 16);
+  p[6] = 0xFF & (offset >>  8);
+  p[7] = 0xFF & (offset      );
+  putU16(p + 8, channels);                 // data length in bytes
+  return DDP_HEADER_LEN + channels;
+}
+
+// root layer shared by E1.31 data and sync packets
+static void e131RootLayer(uint8_t* p, const E131Source& src, uint16_t packetLen, uint8_t vector)
+{
+  putU16(p, 0x0010);                       // preamble size
+  putU16(p +  2, 0);                       // postamble size
+  memcpy(p + 4, acnPacketId, sizeof(acnPacketId));
+  putU16(p + 16, 0x7000 | (packetLen - 16));
+  memset(p + 18, 0, 3); p[21] = vector;    // root vector
+  memcpy(p + 22, src.cid, sizeof(src.cid));
+}
+
+uint16_t e131BuildUniverse(uint8_t* p, const E131Source& src, uint16_t universe, uint16_t channels, uint8_t seq, uint16_t syncUniverse)
+{
+  uint16_t len = E131_OUT_HEADER_LEN + channels;
+  e131RootLayer(p, src, len, 0x04);
+  // framing layer
+  putU16(p + 38, 0x7000 | (len - 38));
+  memset(p + 40, 0, 3); p[43] = 0x02;      // frame vector: data packet
+  memset(p + 44, 0, 64);                   // source name, always 0 terminated
+  for (uint8_t i = 0; src.name && src.name[i] && i < 63; i++) p[44 + i] = src.name[i];
+  p[108] = 100;                            // priority
+  putU16(p + 109, syncUniverse);
+  p[111] = seq;
+  p[112] = 0;                              // options
+  putU16(p + 113, universe);
+  // DMP layer
+  putU16(p + 115, 0x7000 | (len - 115));
+  p[117] = 0x02;                           // set property
+  p[118] = 0xa1;                           // address & data type
+  putU16(p + 119, 0);                      // first property address
+  putU16(p + 121, 1);                      // address increment
+  putU16(p + 123, channels + 1);           // including the start code
+  p[125] = 0;                              // DMX start code
+  return len;
+}
+
+uint16_t e131BuildSync(uint8_t* p, const E131Source& src, uint16_t syncUniverse, uint8_t seq)
+{
+  e131RootLayer(p, src, E131_SYNC_PACKET_LEN, 0x08);
+  putU16(p + 38, 0x7000 | (E131_SYNC_PACKET_LEN - 38));
+  memset(p + 40, 0, 3); p[43] = 0x01;      // frame vector: synchronization
+  p[44] = seq;
+  putU16(p + 45, syncUniverse);
+  putU16(p + 47, 0);                       // reserved
+  return E131_SYNC_PACKET_LEN;
+}
+
+uint16_t artnetBuildUniverse(uint8_t* p, uint16_t universe, uint16_t channels, uint8_t seq)
+{
+  if (channels & 1) p[ARTNET_OUT_HEADER_LEN + channels++] = 0; // length must be even
+  memcpy(p, artnetId, sizeof(artnetId));
+  p[8]  = ARTNET_OPCODE_OPDMX & 0xFF;      // op code, little endian
+  p[9]  = ARTNET_OPCODE_OPDMX >> 8;
+  putU16(p + 10, 14);                      // protocol version
+  p[12] = seq ? seq : 1;                   // 0 disables sequencing
+  p[13] = 0;                               // physical port
+  p[14] = universe & 0xFF;                 // SubUni, little endian
+  p[15] = (universe >> 8) & 0x7F;          // Net
+  putU16(p + 16, channels);
+  return ARTNET_OUT_HEADER_LEN + channels;
+}
+
+uint16_t artnetBuildSync(uint8_t* p)
+{
+  memcpy(p, artnetId, sizeof(artnetId));
+  p[8]  = ARTNET_OPCODE_OPSYNC & 0xFF;
+  p[9]  = ARTNET_OPCODE_OPSYNC >> 8;
+  putU16(p + 10, 14);
+  p[12] = 0; p[13] = 0;                    // aux
+  return ARTNET_SYNC_PACKET_LEN;
+}
+
+bool realtimeSendFrame(uint8_t* buf, realtime_send_function send, uint8_t protocol, const uint8_t* pixels, uint16_t length,
+                       bool rgbw, uint8_t bri, uint32_t start, uint8_t &seq, const E131Source& src, uint16_t syncUniverse)
+{
+  const uint8_t channelsPerLed = rgbw ? 4 : 3;
+
+  if (protocol == REALTIME_OUT_DDP) {
+    // whole pixels per packet: 480 RGB or 360 RGBW
+    const uint16_t ledsPerPacket = DDP_CHANNELS_PER_PACKET / channelsPerLed;
+    uint32_t offset = start;
+    for (uint16_t led = 0; led < length; led += ledsPerPacket) {
+      uint16_t leds = (length - led < ledsPerPacket) ? length - led : ledsPerPacket;
+      uint16_t channels = leds * channelsPerLed;
+      if (++seq > 15) seq = 1;             // 0 would disable sequence checks at the receiver
+      scaleBriSpan(buf + DDP_HEADER_LEN, pixels + led * channelsPerLed, channels, bri);
+      uint16_t len = ddpBuildHeader(buf, seq, led + leds >= length, rgbw, offset, channels); // push with the last packet
+      if (!send(buf, len, 0)) return false;
+      offset += channels;
+    }
+    return true;
+  }
+
+  // whole pixels per universe: 170 RGB or 128 RGBW
+  const bool e131 = (protocol == REALTIME_OUT_E131);
+  const uint16_t ledsPerUniverse = 512 / channelsPerLed;
+  const uint16_t headerLen = e131 ? E131_OUT_HEADER_LEN : ARTNET_OUT_HEADER_LEN;
+  const uint32_t lastUniverse = e131 ? E131_OUT_LAST_UNIVERSE : ARTNET_OUT_LAST_UNIVERSE; // E1.31 universes start at 1
+  uint32_t universe = (e131 && !start) ? 1 : start;
+  if (universe > lastUniverse) return false;
+  if (!++seq) seq = 1;                     // one sequence number per frame, shared by all universes
+
+  for (uint16_t led = 0; led < length && universe <= lastUniverse; led += ledsPerUniverse, universe++) {
+    uint16_t leds = (length - led < ledsPerUniverse) ? length - led : ledsPerUniverse;
+    uint16_t channels = leds * channelsPerLed;
+    scaleBriSpan(buf + headerLen, pixels + led * channelsPerLed, channels, bri);
+    uint16_t len = e131 ? e131BuildUniverse(buf, src, universe, channels, seq, syncUniverse)
+                        : artnetBuildUniverse(buf, universe, channels, seq);
+    if (!send(buf, len, universe)) return false;
+  }
+
+  if (syncUniverse) {
+    uint16_t len = e131 ? e131BuildSync(buf, src, syncUniverse, seq) : artnetBuildSync(buf);
+    send(buf, len, syncUniverse);
+  }
+  return true;
+}
@@ -0,0 +1,55 @@
+#ifndef RealtimeOut_h
+#define RealtimeOut_h
+
+/*
+ * Packet building for the DDP, E1.31 and Art-Net output of network busses, without network dependencies (host tested, see test/)
+ * udp.cpp sends the packets.
+ */
+
+#include <stdint.h>
+#include "src/dependencies/e131/E131Protocol.h"
+
+#define DDP_CHANNELS_PER_PACKET 1440 // 480 RGB or 360 RGBW leds
+
+#define E131_OUT_HEADER_LEN 126   // up to and including the DMX start code
+#define ARTNET_OUT_HEADER_LEN 18
+#define E131_SYNC_PACKET_LEN 49
+#define ARTNET_SYNC_PACKET_LEN 14
+
+#define E131_OUT_LAST_UNIVERSE   63999
+#define ARTNET_OUT_LAST_UNIVERSE 0x7FFF // 15 bit port address
+
+#define REALTIME_OUT_PACKET_SIZE (DDP_HEADER_LEN + DDP_CHANNELS_PER_PACKET) // the largest of the three
+
+#define REALTIME_OUT_DDP    0
+#define REALTIME_OUT_E131   1
+#define REALTIME_OUT_ARTNET 2
+
+// E1.31 identity of the sender
+struct E131Source {
+  uint8_t cid[16];   // component id, unique per device
+  const char* name;  // source name shown by receivers, up to 63 characters are sent
+};
+
+// hands a built packet to the network, universe is the one it carries (the sync universe for E1.31 sync packets, 0 for DDP)
+typedef bool (*realtime_send_function)(const uint8_t* packet, uint16_t len, uint16_t universe);
+
+// the packet builders expect the channel data at p + header length and return the packet length
+uint16_t ddpBuildHeader(uint8_t* p, uint8_t seq, bool push, bool rgbw, uint32_t offset, uint16_t channels);
+uint16_t e131BuildUniverse(uint8_t* p, const E131Source& src, uint16_t universe, uint16_t channels, uint8_t seq, uint16_t syncUniverse);
+uint16_t e131BuildSync(uint8_t* p, const E131Source& src, uint16_t syncUniverse, uint8_t seq);
+uint16_t artnetBuildUniverse(uint8_t* p, uint16_t universe, uint16_t channels, uint8_t seq);
+uint16_t artnetBuildSync(uint8_t* p);
+
+/*
+ * Sends length pixels (3 or 4 channels each) scaled by bri as one frame, built one packet at a time in buf (REALTIME_OUT_PACKET_SIZE bytes).
+ * DDP is split into packets of whole pixels starting at byte offset start, with the push flag on the last one.
+ * E1.31 and Art-Net are split into universes of whole pixels (170 RGB or 128 RGBW) from universe start on (0 means 1 for E1.31),
+ * followed by a sync packet if syncUniverse is set.
+ * seq is the sequence number of the protocol, kept by the caller: DDP counts 1-15 per packet, E1.31 and Art-Net 1-255 per frame.
+ * Returns false if sending a packet failed.
+ */
+bool realtimeSendFrame(uint8_t* buf, realtime_send_function send, uint8_t protocol, const uint8_t* pixels, uint16_t length,
+                       bool rgbw, uint8_t bri, uint32_t start, uint8_t &seq, const E131Source& src, uint16_t syncUniverse);
+
+#endif
@@ -92,14 +92,14 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
     bool busesChanged = false;
     for (uint8_t s = 0; s < WLED_MAX_BUSSES; s++) {
-      char lp[4] = "L0"; lp[2] = 48+s; lp[3] = 0; //ascii 0-9 //strip data pin
-      char lc[4] = "LC"; lc[2] = 48+s; lc[3] = 0; //strip length
-      char co[4] = "CO"; co[2] = 48+s; co[3] = 0; //strip color order
-      char lt[4] = "LT"; lt[2] = 48+s; lt[3] = 0; //strip type
-      char ls[4] = "LS"; ls[2] = 48+s; ls[3] = 0; //strip start LED
-      char cv[4] = "CV"; cv[2] = 48+s; cv[3] = 0; //strip reverse
-      char sl[4] = "SL"; sl[2] = 48+s; sl[3] = 0; //skip first N LEDs
-      char rf[4] = "RF"; rf[2] = 48+s; rf[3] = 0; //refresh required
+      char lp[5]; sprintf_P(lp, PSTR("L0%d"), s); //strip data pin (decimal bus number like the settings page, more than 10 with parallel I2S)
+      char lc[5]; sprintf_P(lc, PSTR("LC%d"), s); //strip length
+      char co[5]; sprintf_P(co, PSTR("CO%d"), s); //strip color order
+      char lt[5]; sprintf_P(lt, PSTR("LT%d"), s); //strip type
+      char ls[5]; sprintf_P(ls, PSTR("LS%d"), s); //strip start LED
+      char cv[5]; sprintf_P(cv, PSTR("CV%d"), s); //strip reverse
+      char sl[5]; sprintf_P(sl, PSTR("SL%d"), s); //skip first N LEDs
+      char rf[5]; sprintf_P(rf, PSTR("RF%d"), s); //refresh required
       if (!request->hasArg(lp)) {
         DEBUG_PRINTLN(F("No data.")); break;
       }
@@ -121,7 +121,13 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
       // actual finalization is done in WLED::loop() (removing old busses and adding new)
       if (busConfigs[s] != nullptr) delete busConfigs[s];
-      busConfigs[s] = new BusConfig(type, pins, start, length, colorOrder, request->hasArg(cv), skip);
+      // the bus refresh rate limit has no field on the settings page yet, keep the one of the bus at this position
+      char fp[5]; sprintf_P(fp, PSTR("FP%d"), s);
+      Bus* oldBus = busses.getBus(s);
+      uint8_t fps = request->hasArg(fp) ? request->arg(fp).toInt() : (oldBus ? oldBus->getTargetFps() : 0);
+      char ch[5]; sprintf_P(ch, PSTR("CH%d"), s); //start channel of network busses, no field either
+      uint32_t startChannel = request->hasArg(ch) ? request->arg(ch).toInt() : (oldBus ? oldBus->getStartChannel() : 0);
+      busConfigs[s] = new BusConfig(type, pins, start, length, colorOrder, request->hasArg(cv), skip, fps, startChannel);
       busesChanged = true;
     }
     //doInitBusses = busesChanged; // we will do that below to ensure all input data is processed
@@ -836,6 +842,13 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   stateChanged |= (fxModeChanged || speedChanged || intensityChanged || paletteChanged);
 
   // apply to main and all selected segments to prevent #1618.
+  strip.startSegmentDataPlan(); // the effect is applied to all of them or none
+  for (uint8_t i = 0; fxModeChanged && i < strip.getMaxSegments(); i++) {
+    WS2812FX::Segment& seg = strip.getSegment(i);
+    if (i != selectedSeg && (singleSegment || !seg.isActive() || !seg.isSelected())) continue;
+    strip.planSegment(i, effectIn, seg.virtualLength());
+  }
+  if (fxModeChanged && !strip.acceptSegmentDataPlan()) errorFlag = ERR_NORAM;
   for (uint8_t i = 0; i < strip.getMaxSegments(); i++) {
     WS2812FX::Segment& seg = strip.getSegment(i);
     if (i != selectedSeg && (singleSegment || !seg.isActive() || !seg.isSelected())) continue; // skip non main segments if not applying to all
@@ -844,6 +857,7 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
     if (intensityChanged) seg.intensity = intensityIn;
     if (paletteChanged)   seg.palette   = paletteIn;
   }
+  strip.endSegmentDataPlan();
 
   //set advanced overlay
   pos = req.indexOf(F("OL="));
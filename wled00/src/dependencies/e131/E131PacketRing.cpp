@@ -0,0 +1,83 @@
+/*
+ * E131PacketRing.cpp
+ *
+ * Queue of received realtime packets between the UDP task and the main loop.
+ */
+
+#include "E131PacketRing.h"
+#include <string.h>
+
+/////////////////////////////////////////////////////////
+//
+// E131PacketRing
+//
+/////////////////////////////////////////////////////////
+
+bool E131PacketRing::begin(size_t size) {
+  size &= ~7UL;
+  _buf = (uint8_t*)malloc(size);
+  if (!_buf) return false;
+  _size = size;
+  _head.store(0);
+  _tail.store(0);
+  return true;
+}
+
+void E131PacketRing::end() {
+  free(_buf);
+  _buf = nullptr;
+  _size = 0;
+}
+
+bool E131PacketRing::push(const uint8_t* data, uint16_t len, uint32_t ip, uint8_t protocol) {
+  uint32_t need = entrySize(len);
+  uint32_t head = _head.load(std::memory_order_relaxed);
+  uint32_t tail = _tail.load(std::memory_order_acquire);
+  uint32_t pos = head;
+  // head must never catch up with tail, that would look like an empty ring
+  if (head >= tail) {
+    uint32_t atEnd = _size - head;
+    if (need > atEnd || (need == atEnd && tail == 0)) {
+      if (need >= tail) { _dropped++; return false; }
+      ((Entry*)(_buf + head))->len = 0xFFFF; // wrap marker, the rest of the buffer is unused
+      pos = 0;
+    }
+  } else if (need >= tail - head) {
+    _dropped++;
+    return false;
+  }
+  Entry* e = (Entry*)(_buf + pos);
+  e->len = len;
+  e->protocol = protocol;
+  e->ip = ip;
+  memcpy(_buf + pos + sizeof(Entry), data, len);
+  pos += need;
+  if (pos == _size) pos = 0;
+  _head.store(pos, std::memory_order_release);
+  return true;
+}
+
+const uint8_t* E131PacketRing::front(uint16_t &len, uint32_t &ip, uint8_t &protocol) {
+  if (!_buf) return nullptr;
+  uint32_t tail = _tail.load(std::memory_order_relaxed);
+  uint32_t head = _head.load(std::memory_order_acquire);
+  if (tail == head) return nullptr;
+  Entry* e = (Entry*)(_buf + tail);
+  if (e->len == 0xFFFF) { // the producer continued at the start
+    tail = 0;
+    _tail.store(0, std::memory_order_release);
+    if (head == 0) return nullptr;
+    e = (Entry*)_buf;
+  }
+  len = e->len;
+  ip = e->ip;
+  protocol = e->protocol;
+  return _buf + tail + sizeof(Entry);
+}
+
+void E131PacketRing::pop() {
+  uint32_t tail = _tail.load(std::memory_order_relaxed);
+  uint32_t pos = tail + entrySize(((Entry*)(_buf + tail))->len);
+  if (pos == _size) pos = 0;
+  _tail.store(pos, std::memory_order_release);
+}
@@ -0,0 +1,52 @@
+/*
+ * E131PacketRing.h
+ *
+ * Queue of received realtime packets between the UDP task and the main loop.
+ * Plain C++ so it can be tested on the host.
+ */
+
+#ifndef E131PACKETRING_H_
+#define E131PACKETRING_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+
+/*
+ * Single-producer/single-consumer ring of received packets.
+ * The AsyncUDP task only copies packets in (push), the main loop takes them out (front/pop),
+ * so packet handlers never run concurrently with the LED output on the other core.
+ * Entries are a header followed by the packet, 8 byte aligned. An entry that does not fit at the end
+ * of the buffer leaves a wrap marker and starts over at the beginning.
+ */
+class E131PacketRing {
+  public:
+    ~E131PacketRing() { free(_buf); }
+
+    bool begin(size_t size);
+    void end();                                                                 // consumer only, once the producer has stopped
+    bool push(const uint8_t* data, uint16_t len, uint32_t ip, uint8_t protocol); // producer only
+    const uint8_t* front(uint16_t &len, uint32_t &ip, uint8_t &protocol);      // consumer only, nullptr if empty
+    void pop();                                                                // consumer only
+    inline bool     isActive() { return _buf != nullptr; }
+    inline bool     isEmpty()  { return _head.load() == _tail.load(); }
+    inline uint32_t dropped()  { return _dropped; }
+
+  private:
+    struct Entry {
+      uint16_t len;      // packet length, 0xFFFF marks a wrap to the buffer start
+      uint8_t  protocol;
+      uint8_t  reserved;
+      uint32_t ip;
+    };
+
+    static inline uint32_t entrySize(uint16_t len) { return (sizeof(Entry) + len + 7) & ~7UL; }
+
+    uint8_t* _buf = nullptr;
+    uint32_t _size = 0;
+    std::atomic<uint32_t> _head{0}; // next write offset, owned by the producer
+    std::atomic<uint32_t> _tail{0}; // next read offset, owned by the consumer
+    volatile uint32_t _dropped = 0; // packets that did not fit
+};
+
+#endif  // E131PACKETRING_H_
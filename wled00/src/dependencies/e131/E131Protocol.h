@@ -0,0 +1,68 @@
+/*
+ * E131Protocol.h
+ *
+ * Ports, offsets and constants of E1.31 (sACN), Art-Net and DDP, shared by the receiver and the senders.
+ */
+
+#ifndef E131PROTOCOL_H_
+#define E131PROTOCOL_H_
+
+// Defaults
+#define E131_DEFAULT_PORT   5568
+#define ARTNET_DEFAULT_PORT 6454
+#define DDP_DEFAULT_PORT    4048
+
+#define DDP_HEADER_LEN 10
+#define DDP_TIMECODE_LEN 4
+
+#define DDP_FLAGS_VER1 0x40
+#define DDP_TIMECODE_FLAG 0x10
+#define DDP_STORAGE_FLAG 0x08
+#define DDP_REPLY_FLAG 0x04
+#define DDP_QUERY_FLAG 0x02
+#define DDP_PUSH_FLAG 0x01
+
+// data type: bits 5-3 type (1 RGB, 3 RGBW), bits 2-0 bits per element (3 = 8 bit, 4 = 16 bit)
+#define DDP_TYPE_RGB24  0x0B
+#define DDP_TYPE_RGB48  0x0C
+#define DDP_TYPE_RGBW32 0x1B
+#define DDP_TYPE_RGBW64 0x1C
+
+#define DDP_ID_DISPLAY 1
+#define DDP_ID_CONFIG  250
+#define DDP_ID_STATUS  251
+#define DDP_ID_ALL     255
+
+#define ARTNET_OPCODE_OPDMX 0x5000
+#define ARTNET_OPCODE_OPSYNC 0x5200
+
+#define P_E131   0
+#define P_ARTNET 1
+#define P_DDP    2
+
+// E1.31 Packet Offsets
+#define E131_ROOT_PREAMBLE_SIZE 0
+#define E131_ROOT_POSTAMBLE_SIZE 2
+#define E131_ROOT_ID 4
+#define E131_ROOT_FLENGTH 16
+#define E131_ROOT_VECTOR 18
+#define E131_ROOT_CID 22
+
+#define E131_FRAME_FLENGTH 38
+#define E131_FRAME_VECTOR 40
+#define E131_FRAME_SOURCE 44
+#define E131_FRAME_PRIORITY 108
+#define E131_FRAME_RESERVED 109
+#define E131_FRAME_SEQ 111
+#define E131_FRAME_OPT 112
+#define E131_FRAME_UNIVERSE 113
+
+#define E131_DMP_FLENGTH 115
+#define E131_DMP_VECTOR 117
+#define E131_DMP_TYPE 118
+#define E131_DMP_ADDR_FIRST 119
+#define E131_DMP_ADDR_INC 121
+#define E131_DMP_COUNT 123
+#define E131_DMP_DATA 125
+
+#endif  // E131PROTOCOL_H_
@@ -38,9 +38,11 @@ ESPAsyncE131::ESPAsyncE131(e131_packet_callback_function callback) {
 //
 /////////////////////////////////////////////////////////
 
-bool ESPAsyncE131::begin(bool multicast, uint16_t port, uint16_t universe, uint8_t n) {
+bool ESPAsyncE131::begin(bool multicast, uint16_t port, uint16_t universe, uint16_t n, size_t queueSize) {
   bool success = false;
 
+  setupQueue(queueSize); // before packets can arrive on a new listener
+
   if (multicast) {
 		success = initMulticast(port, universe, n);
 	} else {
@@ -66,23 +68,17 @@ bool ESPAsyncE131::initUnicast(uint16_t port) {
   return success;
 }
 
-bool ESPAsyncE131::initMulticast(uint16_t port, uint16_t universe, uint8_t n) {
+bool ESPAsyncE131::initMulticast(uint16_t port, uint16_t universe, uint16_t n) {
   bool success = false;
 
   IPAddress address = IPAddress(239, 255, ((universe >> 8) & 0xff),
     ((universe >> 0) & 0xff));
 
   if (udp.listenMulticast(address, port)) {
-    ip4_addr_t ifaddr;
-    ip4_addr_t multicast_addr;
-
-    ifaddr.addr = static_cast<uint32_t>(Network.localIP());
-    for (uint8_t i = 1; i < n; i++) {
-        multicast_addr.addr = static_cast<uint32_t>(IPAddress(239, 255,
-          (((universe + i) >> 8) & 0xff), (((universe + i) >> 0)
-          & 0xff)));
-      igmp_joingroup(&ifaddr, &multicast_addr);
-    }
+    _multicast = true;
+    _listenUniverse = universe;
+    _mcUniverse = _mcCount = _mcSync = 0; // the interface (re)started without the other groups
+    joinUniverses(universe, n);
 
     udp.onPacket(std::bind(&ESPAsyncE131::parsePacket, this, std::placeholders::_1));
 
@@ -91,6 +87,42 @@ bool ESPAsyncE131::initMulticast(uint16_t port, uint16_t universe, uint8_t n) {
   return success;
 }
 
+bool ESPAsyncE131::igmpGroup(uint16_t universe, bool join) {
+  ip4_addr_t ifaddr;
+  ip4_addr_t multicast_addr;
+
+  ifaddr.addr = static_cast<uint32_t>(Network.localIP());
+  multicast_addr.addr = static_cast<uint32_t>(IPAddress(239, 255,
+    ((universe >> 8) & 0xff), ((universe >> 0) & 0xff)));
+  if (join) return igmp_joingroup(&ifaddr, &multicast_addr) == ERR_OK;
+  return igmp_leavegroup(&ifaddr, &multicast_addr) == ERR_OK;
+}
+
+static inline bool inUniverses(uint16_t u, uint16_t first, uint16_t n, uint16_t sync) {
+  return (uint16_t)(u - first) < n || (sync && u == sync);
+}
+
+void ESPAsyncE131::joinUniverses(uint16_t universe, uint16_t n, uint16_t syncUniverse) {
+  if (!_multicast) return;
+  if (universe == _mcUniverse && n == _mcCount && syncUniverse == _mcSync) return;
+
+  // leave first, the IGMP group table of lwIP (MEMP_NUM_IGMP_GROUP) is small
+  for (uint16_t i = 0; i <= _mcCount; i++) {
+    uint16_t u = (i < _mcCount) ? _mcUniverse + i : _mcSync;
+    if (!u || u == _listenUniverse || (i == _mcCount && inUniverses(u, _mcUniverse, _mcCount, 0))) continue;
+    if (!inUniverses(u, universe, n, syncUniverse)) igmpGroup(u, false);
+  }
+  // one group per universe, as far as the table allows
+  for (uint16_t i = 0; i <= n; i++) {
+    uint16_t u = (i < n) ? universe + i : syncUniverse;
+    if (!u || u == _listenUniverse || (i == n && inUniverses(u, universe, n, 0))) continue;
+    if (!inUniverses(u, _mcUniverse, _mcCount, _mcSync) && !igmpGroup(u, true)) break;
+  }
+  _mcUniverse = universe;
+  _mcCount = n;
+  _mcSync = syncUniverse;
+}
+
 /////////////////////////////////////////////////////////
 //
 // Packet parsing - Private
@@ -110,8 +142,11 @@ void ESPAsyncE131::parsePacket(AsyncUDPPacket _packet) {
 	if (protocol == P_ARTNET) {
 		if (memcmp(sbuff->art_id, ESPAsyncE131::ART_ID, sizeof(sbuff->art_id)))
 			error = true; //not "Art-Net"
-		if (sbuff->art_opcode != ARTNET_OPCODE_OPDMX)
-			error = true; //not a DMX packet
+		if (sbuff->art_opcode != ARTNET_OPCODE_OPDMX && sbuff->art_opcode != ARTNET_OPCODE_OPSYNC)
+			error = true; //not a DMX or sync packet
+	} else if (htonl(sbuff->root_vector) == ESPAsyncE131::VECTOR_ROOT_EXTENDED) { //E1.31 sync packet
+		if (htonl(sbuff->syn_vector) != ESPAsyncE131::VECTOR_EXTENDED_SYNC)
+			error = true;
 	} else { //E1.31 error handling
 		if (htonl(sbuff->root_vector) != ESPAsyncE131::VECTOR_ROOT)
 			error = true;
@@ -129,6 +164,77 @@ void ESPAsyncE131::parsePacket(AsyncUDPPacket _packet) {
   }
 
   if (!error) {
-    _callback(sbuff, _packet.remoteIP(), protocol);
+    uint16_t len = _packet.length() < sizeof(e131_packet_t) ? _packet.length() : sizeof(e131_packet_t);
+    if (queuePacket(_packet.data(), len, _packet.remoteIP(), protocol)) return;
+    _callback(sbuff, _packet.remoteIP(), protocol); // without the memory, packets are handled in the UDP task
+  }
+}
+
+// true if the queue takes care of the packet (it may drop it, counted), false to pass it to the callback right away
+bool ESPAsyncE131::queuePacket(const uint8_t* data, uint16_t len, uint32_t ip, uint8_t protocol) {
+  _pushing.store(true);  // before looking at the state, setupQueue() waits for it before freeing the ring
+  uint8_t state = _queueState.load();
+  bool queued = (state != QUEUE_DIRECT);
+  #ifdef ESP8266
+  // packets arrive between loop() runs, they only need to wait while paused or behind others that wait
+  if (state == QUEUE_ON && !_paused && _queue.isEmpty()) queued = false;
+  #endif
+  if (queued) {
+    if (state == QUEUE_ON) _queue.push(data, len, ip, protocol); // counts the packet if it does not fit
+    else _lost++;                                                // the ring is being replaced
   }
-}
\ No newline at end of file
+  _pushing.store(false);
+  return queued;
+}
+
+// (re)allocates the ring, from the main loop. Packets still in the old one are counted as dropped
+void ESPAsyncE131::setupQueue(size_t size) {
+  if (size == _queueSize && _queueState.load() != QUEUE_OFF) return;
+  _queueState.store(QUEUE_OFF);
+  while (_pushing.load()) yield(); // a push that saw QUEUE_ON is still copying
+  if (_queue.isActive()) {
+    uint16_t len;
+    uint32_t ip;
+    uint8_t protocol;
+    while (_queue.front(len, ip, protocol)) { _queue.pop(); _lost++; }
+    _queue.end();
+  }
+  _queueSize = size;
+  // without the memory, packets are handled in the UDP task
+  _queueState.store((size && _queue.begin(size)) ? QUEUE_ON : QUEUE_DIRECT);
+}
+
+/////////////////////////////////////////////////////////
+//
+// Packet queue - Public
+//
+/////////////////////////////////////////////////////////
+
+void ESPAsyncE131::handleQueue() {
+  if (_queueState.load() != QUEUE_ON) return;
+
+  uint16_t len;
+  uint32_t ip;
+  uint8_t protocol;
+  // bounded, so a packet flood can not keep the loop from rendering
+  for (uint8_t n = 0; n < 255 && !_paused; n++) {
+    const uint8_t* data = _queue.front(len, ip, protocol);
+    if (!data) break;
+    // handlers may read the full packet struct, so short packets are passed as a zero padded copy
+    static e131_packet_t pkt;
+    memcpy(pkt.raw, data, len);
+    if (len < sizeof(pkt.raw)) memset(pkt.raw + len, 0, sizeof(pkt.raw) - len);
+    _queue.pop();
+    _draining = true;
+    _callback(&pkt, IPAddress(ip), protocol);
+    _draining = false;
+  }
+}
+
+size_t ESPAsyncE131::writeTo(const uint8_t* data, size_t len, IPAddress ip, uint16_t port) {
+  return udp.writeTo(data, len, ip, port);
+}
+
+uint32_t ESPAsyncE131::droppedPackets() {
+  return _queue.dropped() + _lost.load();
+}
@@ -36,6 +36,9 @@
 #else
 #error Platform not supported
 #endif
+#include <atomic>
+#include "E131Protocol.h"
+#include "E131PacketRing.h"
 
 #include <lwip/ip_addr.h>
 #include <lwip/igmp.h>
@@ -45,45 +48,6 @@
 typedef struct ip_addr ip4_addr_t;
 #endif
 
-// Defaults
-#define E131_DEFAULT_PORT   5568
-#define ARTNET_DEFAULT_PORT 6454
-#define DDP_DEFAULT_PORT    4048
-
-#define DDP_PUSH_FLAG 0x01
-#define DDP_TIMECODE_FLAG 0x10
-
-#define ARTNET_OPCODE_OPDMX 0x5000
-
-#define P_E131   0
-#define P_ARTNET 1
-#define P_DDP    2
-
-// E1.31 Packet Offsets
-#define E131_ROOT_PREAMBLE_SIZE 0
-#define E131_ROOT_POSTAMBLE_SIZE 2
-#define E131_ROOT_ID 4
-#define E131_ROOT_FLENGTH 16
-#define E131_ROOT_VECTOR 18
-#define E131_ROOT_CID 22
-
-#define E131_FRAME_FLENGTH 38
-#define E131_FRAME_VECTOR 40
-#define E131_FRAME_SOURCE 44
-#define E131_FRAME_PRIORITY 108
-#define E131_FRAME_RESERVED 109
-#define E131_FRAME_SEQ 111
-#define E131_FRAME_OPT 112
-#define E131_FRAME_UNIVERSE 113
-
-#define E131_DMP_FLENGTH 115
-#define E131_DMP_VECTOR 117
-#define E131_DMP_TYPE 118
-#define E131_DMP_ADDR_FIRST 119
-#define E131_DMP_ADDR_INC 121
-#define E131_DMP_COUNT 123
-#define E131_DMP_DATA 125
-
 // E1.31 Packet Structure
 typedef union {
     struct { //E1.31 packet
@@ -100,7 +64,7 @@ typedef union {
       uint32_t frame_vector;
       uint8_t  source_name[64];
       uint8_t  priority;
-      uint16_t reserved;
+      uint16_t sync_address;    // universe carrying the sync packets for this data, 0 if unsynchronized
       uint8_t  sequence_number;
       uint8_t  options;
       uint16_t universe;
@@ -115,6 +79,15 @@ typedef union {
       uint8_t  property_values[513];
     } __attribute__((packed));
 	
+  struct { //E1.31 synchronization packet (root layer as above, vector 8)
+    uint8_t  syn_root[38];
+    uint16_t syn_flength;
+    uint32_t syn_vector;
+    uint8_t  syn_sequence_number;
+    uint16_t syn_address;
+    uint16_t syn_reserved;
+  } __attribute__((packed));
+
 	struct { //Art-Net packet
     uint8_t  art_id[8];
     uint16_t art_opcode;
@@ -137,16 +110,11 @@ typedef union {
     uint8_t data[1];
   } __attribute__((packed));
 
-  /*struct { //DDP Time code Header (unsupported)
-    uint8_t flags;
-    uint8_t sequenceNum;
-    uint8_t dataType;
-    uint8_t destination;
-    uint32_t channelOffset;
-    uint16_t dataLen;
-    uint32_t timeCode;
-    uint8_t data[1];
-  } __attribute__((packed));*/
+  struct { //DDP Time code Header (flags & DDP_TIMECODE_FLAG)
+    uint8_t tc_header[DDP_HEADER_LEN];
+    uint32_t timeCode;  // middle 32 bits of an NTP timestamp (1/65536 s)
+    uint8_t tc_data[1];
+  } __attribute__((packed));
 
   uint8_t raw[1458];
 } e131_packet_t;
@@ -160,6 +128,8 @@ class ESPAsyncE131 {
     static const uint8_t ACN_ID[];
 	  static const uint8_t ART_ID[];
     static const uint32_t VECTOR_ROOT = 4;
+    static const uint32_t VECTOR_ROOT_EXTENDED = 8;
+    static const uint32_t VECTOR_EXTENDED_SYNC = 1;
     static const uint32_t VECTOR_FRAME = 2;
     static const uint8_t VECTOR_DMP = 2;
 
@@ -167,18 +137,56 @@ class ESPAsyncE131 {
 
     // Internal Initializers
     bool initUnicast(uint16_t port);
-    bool initMulticast(uint16_t port, uint16_t universe, uint8_t n = 1);
+    bool initMulticast(uint16_t port, uint16_t universe, uint16_t n = 1);
+
+    // multicast groups joined in addition to the one of the listening universe
+    bool     _multicast = false;
+    uint16_t _listenUniverse = 0;
+    uint16_t _mcUniverse = 0, _mcCount = 0, _mcSync = 0;
+    bool igmpGroup(uint16_t universe, bool join);
 
     // Packet parser callback
     void parsePacket(AsyncUDPPacket _packet);
+    bool queuePacket(const uint8_t* data, uint16_t len, uint32_t ip, uint8_t protocol);
+    void setupQueue(size_t size);
     
     e131_packet_callback_function _callback = nullptr;
+    // the ring is allocated by begin() in the main loop, QUEUE_OFF while it is replaced
+    enum QueueState : uint8_t { QUEUE_OFF, QUEUE_ON, QUEUE_DIRECT };
+    E131PacketRing  _queue;
+    size_t _queueSize = 0;
+    std::atomic<uint8_t> _queueState{QUEUE_OFF};
+    std::atomic<bool> _pushing{false}; // the UDP task is handing a packet to the ring
+    volatile bool _paused = false;     // the application has a frame to show first
+    bool _draining = false;            // handleQueue() is calling the callback
+    std::atomic<uint32_t> _lost{0};    // packets that arrived while the ring was replaced or were still in the old one
 
  public:
     ESPAsyncE131(e131_packet_callback_function callback);
 
     // Generic UDP listener, no physical or IP configuration
-    bool begin(bool multicast, uint16_t port = E131_DEFAULT_PORT, uint16_t universe = 1, uint8_t n = 1);
+    // queueSize > 0: packets are queued by the UDP task and passed to the callback by handleQueue(),
+    // on ESP8266 only the ones that arrive while paused
+    bool begin(bool multicast, uint16_t port = E131_DEFAULT_PORT, uint16_t universe = 1, uint16_t n = 1, size_t queueSize = 0);
+    // calls the callback for queued packets, to be called from the main loop
+    void handleQueue();
+    // replaces the queue with one of queueSize bytes (0 for none) from the main loop, packets still queued are dropped
+    inline void setQueueSize(size_t queueSize) { setupQueue(queueSize); }
+    // bytes allocated for the queue
+    inline size_t queueSize() { return isQueued() ? _queueSize : 0; }
+    // joins the multicast groups of n universes from universe on and of the sync universe (0 for none),
+    // leaves the ones no longer needed. Call from the main loop when the counts change, no-op for unicast
+    void joinUniverses(uint16_t universe, uint16_t n, uint16_t syncUniverse = 0);
+    // holds packets back in the queue, e.g. until a completed frame is shown
+    inline void pause()  { _paused = true; }
+    inline void resume() { _paused = false; }
+    // true while the callback is called by handleQueue(), i.e. from the main loop
+    inline bool isDraining() { return _draining; }
+    // true if packets go through the queue, i.e. pause() holds them back
+    inline bool isQueued() { return _queueState.load() == QUEUE_ON; }
+    uint32_t droppedPackets();
+    // sends a reply from the listening port, e.g. answers to DDP queries
+    size_t writeTo(const uint8_t* data, size_t len, IPAddress ip, uint16_t port);
 };
 
 #endif  // ESPASYNCE131_H_
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "wled.h"
+#include "realtime_out.h"
 
 /*
  * UDP sync notifier / Realtime / Hyperion / TPM2.NET
@@ -10,6 +11,9 @@
 #define UDP_IN_MAXSIZE 1472
 #define PRESUMED_NETWORK_DELAY 3 //how many ms could it take on avg to reach the receiver? This will be added to transmitted times
 
+static uint8_t* udpIn = nullptr;     //receive buffer shared by all notifier and realtime sockets, allocated on first use
+static bool udpShowPending = false;  //a realtime packet was applied while draining the sockets
+
 void notify(byte callMode, bool followUp)
 {
   if (!udpConnected) return;
@@ -198,27 +202,10 @@ void sendTPM2Ack() {
 }
 
 
-void handleNotifications()
+// reads and handles one packet from the notifier, supplemental notifier or raw RGB socket
+// returns false if none of them had a packet pending
+static bool handleUdpPacket()
 {
-  IPAddress localIP;
-
-  //send second notification if enabled
-  if(udpConnected && notificationTwoRequired && millis()-notificationSentTime > 250){
-    notify(notificationSentCallMode,true);
-  }
-  
-  if (e131NewData && millis() - strip.getLastShow() > 15)
-  {
-    e131NewData = false;
-    strip.show();
-  }
-
-  //unlock strip when realtime UDP times out
-  if (realtimeMode && millis() > realtimeTimeout) exitRealtime();
-
-  //receive UDP notifications
-  if (!udpConnected) return;
-    
   bool isSupp = false;
   uint16_t packetSize = notifierUdp.parsePacket();
   if (!packetSize && udp2Connected) {
@@ -230,41 +217,40 @@ void handleNotifications()
   if (!packetSize && udpRgbConnected) {
     packetSize = rgbUdp.parsePacket();
     if (packetSize) {
-      if (!receiveDirect) return;
-      if (packetSize > UDP_IN_MAXSIZE || packetSize < 3) return;
+      if (!receiveDirect) return true;
+      if (packetSize > UDP_IN_MAXSIZE || packetSize < 3) return true;
       realtimeIP = rgbUdp.remoteIP();
       DEBUG_PRINTLN(rgbUdp.remoteIP());
-      uint8_t lbuf[packetSize];
-      rgbUdp.read(lbuf, packetSize);
+      rgbUdp.read(udpIn, packetSize);
       realtimeLock(realtimeTimeoutMs, REALTIME_MODE_HYPERION);
-      if (realtimeOverride) return;
+      if (realtimeOverride) return true;
       uint16_t id = 0;
       uint16_t totalLen = strip.getLengthTotal();
       for (uint16_t i = 0; i < packetSize -2; i += 3)
       {
-        setRealtimePixel(id, lbuf[i], lbuf[i+1], lbuf[i+2], 0);
+        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
         id++; if (id >= totalLen) break;
       }
-      strip.show();
-      return;
+      udpShowPending = true;
+      return true;
     } 
   }
+  if (!packetSize) return false;
 
-  if (!(receiveNotifications || receiveDirect)) return;
+  if (!(receiveNotifications || receiveDirect)) return true;
   
-  localIP = Network.localIP();
+  IPAddress localIP = Network.localIP();
   //notifier and UDP realtime
-  if (!packetSize || packetSize > UDP_IN_MAXSIZE) return;
-  if (!isSupp && notifierUdp.remoteIP() == localIP) return; //don't process broadcasts we send ourselves
+  if (packetSize > UDP_IN_MAXSIZE) return true;
+  if (!isSupp && notifierUdp.remoteIP() == localIP) return true; //don't process broadcasts we send ourselves
 
-  uint8_t udpIn[packetSize +1];
   uint16_t len;
   if (isSupp) len = notifier2Udp.read(udpIn, packetSize);
   else        len =  notifierUdp.read(udpIn, packetSize);
 
   // WLED nodes info notifications
   if (isSupp && udpIn[0] == 255 && udpIn[1] == 1 && len >= 40) {
-    if (!nodeListEnabled || notifier2Udp.remoteIP() == localIP) return;
+    if (!nodeListEnabled || notifier2Udp.remoteIP() == localIP) return true;
 
     uint8_t unit = udpIn[39];
     NodesMap::iterator it = Nodes.find(unit);
@@ -290,15 +276,15 @@ void handleNotifications()
           build |= udpIn[40+i]<<(8*i);
       it->second.build = build;
     }
-    return;
+    return true;
   }
 
   //wled notifier, ignore if realtime packets active
   if (udpIn[0] == 0 && !realtimeMode && receiveNotifications)
   {
     //ignore notification if received within a second after sending a notification ourselves
-    if (millis() - notificationSentTime < 1000) return;
-    if (udpIn[1] > 199) return; //do not receive custom versions
+    if (millis() - notificationSentTime < 1000) return true;
+    if (udpIn[1] > 199) return true; //do not receive custom versions
 
     //compatibilityVersionByte: 
     byte version = udpIn[11];
@@ -306,8 +292,8 @@ void handleNotifications()
     // if we are not part of any sync group ignore message
     if (version < 9 || version > 199) {
       // legacy senders are treated as if sending in sync group 1 only
-      if (!(receiveGroups & 0x01)) return;
-    } else if (!(receiveGroups & udpIn[36])) return;
+      if (!(receiveGroups & 0x01)) return true;
+    } else if (!(receiveGroups & udpIn[36])) return true;
     
     bool someSel = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects);
 
@@ -338,6 +324,23 @@ void handleNotifications()
       if (applyEffects && currentPlaylist >= 0) unloadPlaylist();
       if (version > 10 && (receiveSegmentOptions || receiveSegmentBounds)) {
         uint8_t numSrcSegs = udpIn[39];
+        //plan the effect data of all synced segments before applying any of them
+        strip.startSegmentDataPlan();
+        for (uint8_t i = 0; applyEffects && receiveSegmentOptions && i < numSrcSegs; i++) {
+          uint16_t ofs = 41 + i*udpIn[40];
+          uint8_t id = udpIn[0 +ofs];
+          if (id >= strip.getMaxSegments()) continue;
+          WS2812FX::Segment seg = strip.getSegment(id); //copy, only used for the planned length
+          if (receiveSegmentBounds) {
+            seg.start = (udpIn[1+ofs] << 8 | udpIn[2+ofs]);
+            seg.stop  = (udpIn[3+ofs] << 8 | udpIn[4+ofs]);
+          }
+          seg.grouping = udpIn[5+ofs] ? udpIn[5+ofs] : seg.grouping;
+          seg.spacing  = udpIn[6+ofs];
+          seg.options  = (seg.options & ~MIRROR) | (udpIn[9+ofs] & MIRROR);
+          strip.planSegment(id, udpIn[11+ofs], seg.isActive() ? seg.virtualLength() : 0);
+        }
+        strip.acceptSegmentDataPlan();
         for (uint8_t i = 0; i < numSrcSegs; i++) {
           uint16_t ofs = 41 + i*udpIn[40]; //start of segment offset byte
           uint8_t id = udpIn[0 +ofs];
@@ -371,11 +374,18 @@ void handleNotifications()
             strip.setSegment(id, selseg.start, selseg.stop, udpIn[5+ofs], udpIn[6+ofs], selseg.offset);
           }
         }
+        strip.endSegmentDataPlan();
         stateChanged = true;
       }
       
       // simple effect sync, applies to all selected segments
       if (applyEffects && (version < 11 || !receiveSegmentOptions)) {
+        strip.startSegmentDataPlan(); //the effect is applied to all of them or none
+        for (uint8_t i = 0; udpIn[8] < strip.getModeCount() && i < strip.getMaxSegments(); i++) {
+          WS2812FX::Segment& seg = strip.getSegment(i);
+          if (seg.isActive() && seg.isSelected()) strip.planSegment(i, udpIn[8], seg.virtualLength());
+        }
+        strip.acceptSegmentDataPlan();
         for (uint8_t i = 0; i < strip.getMaxSegments(); i++) {
           WS2812FX::Segment& seg = strip.getSegment(i);
           if (!seg.isActive() || !seg.isSelected()) continue;
@@ -384,6 +394,7 @@ void handleNotifications()
           if (version > 2) seg.intensity = udpIn[16];
           if (version > 4 && udpIn[19] < strip.getPaletteCount()) seg.palette = udpIn[19];
         }
+        strip.endSegmentDataPlan();
         stateChanged = true;
       }
 
@@ -430,10 +441,10 @@ void handleNotifications()
     
     if (receiveNotificationBrightness || !someSel) bri = udpIn[2];
     stateUpdated(CALL_MODE_NOTIFICATION);
-    return;
+    return true;
   }
 
-  if (!receiveDirect) return;
+  if (!receiveDirect) return true;
   
   //TPM2.NET
   if (udpIn[0] == 0x9c)
@@ -442,13 +453,13 @@ void handleNotifications()
     //if the number of LEDs in your installation doesn't allow that, please include padding bytes at the end of the last packet
     byte tpmType = udpIn[1];
     if (tpmType == 0xaa) { //TPM2.NET polling, expect answer
-      sendTPM2Ack(); return;
+      sendTPM2Ack(); return true;
     }
-    if (tpmType != 0xda) return; //return if notTPM2.NET data
+    if (tpmType != 0xda) return true; //return if notTPM2.NET data
 
     realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
     realtimeLock(realtimeTimeoutMs, REALTIME_MODE_TPM2NET);
-    if (realtimeOverride) return;
+    if (realtimeOverride) return true;
 
     tpmPacketCount++; //increment the packet count
     if (tpmPacketCount == 1) tpmPayloadFrameSize = (udpIn[2] << 8) + udpIn[3]; //save frame size for the whole payload if this is the first packet
@@ -469,9 +480,9 @@ void handleNotifications()
     if (tpmPacketCount == numPackets) //reset packet count and show if all packets were received
     {
       tpmPacketCount = 0;
-      strip.show();
+      udpShowPending = true;
     }
-    return;
+    return true;
   }
 
   //UDP realtime: 1 warls 2 drgb 3 drgbw
@@ -479,16 +490,16 @@ void handleNotifications()
   {
     realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
     DEBUG_PRINTLN(realtimeIP);
-    if (packetSize < 2) return;
+    if (packetSize < 2) return true;
 
     if (udpIn[1] == 0)
     {
       realtimeTimeout = 0;
-      return;
+      return true;
     } else {
       realtimeLock(udpIn[1]*1000 +1, REALTIME_MODE_UDP);
     }
-    if (realtimeOverride) return;
+    if (realtimeOverride) return true;
 
     uint16_t totalLen = strip.getLengthTotal();
     if (udpIn[0] == 1) //warls
@@ -534,8 +545,8 @@ void handleNotifications()
         id++;
       }
     }
-    strip.show();
-    return;
+    udpShowPending = true;
+    return true;
   }
 
   // API over UDP
@@ -551,8 +562,57 @@ void handleNotifications()
     JsonObject root = jsonBuffer.as<JsonObject>();
     if (!error && !root.isNull()) deserializeState(root);
   }
+  return true;
+}
+
+// shows a frame received via E1.31, Art-Net or DDP, main loop only
+void showRealtimeFrame()
+{
+  e131NewData = false;
+  strip.show();
+  if (e131FrameReadyAt) {
+    e131ShowLatency = micros() - e131FrameReadyAt;
+    e131ShowLatencyAvg = e131ShowLatencyAvg ? (e131ShowLatencyAvg * 7 + e131ShowLatency) >> 3 : e131ShowLatency;
+    e131FrameReadyAt = 0;
+  }
+  e131FramesShown++;
+  e131.resume(); // packets held back for this frame
+  ddp.resume();
 }
 
+void handleNotifications()
+{
+  //send second notification if enabled
+  if(udpConnected && notificationTwoRequired && millis()-notificationSentTime > 250){
+    notify(notificationSentCallMode,true);
+  }
+  
+  handleE131Frames();
+  if (e131NewData) showRealtimeFrame();
+
+  //unlock strip when realtime UDP times out
+  if (realtimeMode && millis() > realtimeTimeout) exitRealtime();
+
+  //receive UDP notifications
+  if (!udpConnected) return;
+    
+  if (!udpIn) udpIn = (uint8_t*)malloc(UDP_IN_MAXSIZE +1);
+  if (!udpIn) return;
+
+  //drain all pending packets within a time budget, a slow loop would otherwise let them pile up and get dropped by lwIP
+  unsigned long drainStart = micros();
+  for (uint8_t n = 0; n < UDP_MAX_PACKETS_PER_LOOP; n++) {
+    if (!handleUdpPacket()) break;
+    if (micros() - drainStart > UDP_DRAIN_BUDGET_US) break;
+  }
+  //realtime frames are shown once for all packets drained
+  if (udpShowPending) {
+    udpShowPending = false;
+    strip.show();
+  }
+}
+
+
 
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
 {
@@ -568,6 +628,30 @@ void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
   }
 }
 
+// bulk version of setRealtimePixel() for count RGB(W) tuples packed in data, e.g. a DMX universe
+void setRealtimePixels(uint16_t i, const uint8_t* data, uint16_t count, bool rgbw)
+{
+  uint16_t pix = i + arlsOffset;
+  uint16_t totalLen = strip.getLengthTotal();
+  if (pix >= totalLen) return;
+  if (count > totalLen - pix) count = totalLen - pix;
+  const uint8_t* gamma = (!arlsDisableGammaCorrection && strip.gammaCorrectCol) ? strip.getGammaTable() : nullptr;
+  const uint8_t stride = rgbw ? 4 : 3;
+
+  uint32_t cols[64];
+  while (count) {
+    uint16_t n = (count < 64) ? count : 64;
+    for (uint16_t j = 0; j < n; j++, data += stride) {
+      byte w = rgbw ? data[3] : 0;
+      if (gamma) cols[j] = RGBW32(gamma[data[0]], gamma[data[1]], gamma[data[2]], gamma[w]);
+      else       cols[j] = RGBW32(data[0], data[1], data[2], w);
+    }
+    strip.setPixelColors(pix, cols, n);
+    pix += n;
+    count -= n;
+  }
+}
+
 /*********************************************************************************************\
    Refresh aging for remote units, drop if too old...
 \*********************************************************************************************/
@@ -643,23 +727,27 @@ void sendSysInfoUDP()
  * Art-Net, DDP, E131 output - work in progress
 \*********************************************************************************************/
 
-#define DDP_HEADER_LEN 10
 #define DDP_SYNCPACKET_LEN 10
 
-#define DDP_FLAGS1_VER 0xc0  // version mask
-#define DDP_FLAGS1_VER1 0x40 // version=1
-#define DDP_FLAGS1_PUSH 0x01
-#define DDP_FLAGS1_QUERY 0x02
-#define DDP_FLAGS1_REPLY 0x04
-#define DDP_FLAGS1_STORAGE 0x08
-#define DDP_FLAGS1_TIME 0x10
-
-#define DDP_ID_DISPLAY 1
-#define DDP_ID_CONFIG 250
-#define DDP_ID_STATUS 251
+static AsyncUDP realtimeOutUdp;   // pbufs are sent directly, no per packet WiFiUDP buffer
+static uint8_t* realtimeOutPacket = nullptr; // reused for every output packet, see realtime_out.cpp for the packets
+static uint8_t  realtimeOutSeq = 0;
+static uint8_t  realtimeOutType = 0;
+static IPAddress realtimeOutClient;
 
-// 1440 channels per packet
-#define DDP_CHANNELS_PER_PACKET 1440 // 480 leds
+static bool realtimeOutSend(const uint8_t* packet, uint16_t len, uint16_t universe)
+{
+  IPAddress client = realtimeOutClient;
+  uint16_t port = DDP_DEFAULT_PORT;
+  if (realtimeOutType == REALTIME_OUT_E131) {
+    port = E131_DEFAULT_PORT;
+    // multicast busses send each universe to its group
+    if (client[0] >= 224 && client[0] <= 239) client = IPAddress(239, 255, universe >> 8, universe & 0xFF);
+  } else if (realtimeOutType == REALTIME_OUT_ARTNET) {
+    port = ARTNET_DEFAULT_PORT;
+  }
+  return realtimeOutUdp.writeTo(packet, len, client, port) == len;
+}
 
 //
 // Send real time UDP updates to the specified client
@@ -669,86 +757,33 @@ void sendSysInfoUDP()
 // length - the number of pixels
 // buffer - a buffer of at least length*4 bytes long
 // isRGBW - true if the buffer contains 4 components per pixel
+// startChannel - DDP data offset of the first pixel at the receiver,
+//                first universe for E1.31 (0 means 1) and Art-Net
 
 uint8_t sequenceNumber = 0; // this needs to be shared across all outputs
 
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri, bool isRGBW)  {
-  if (!(apActive || interfacesInited) || !client[0] || !length) return 1;  // network not initialised or dummy/unset IP address  031522 ajn added check for ap 
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri, bool isRGBW, uint32_t startChannel)  {
+  if (!(apActive || interfacesInited) || !client[0] || !length || type > REALTIME_OUT_ARTNET) return 1;  // network not initialised or dummy/unset IP address  031522 ajn added check for ap 
 
-  WiFiUDP ddpUdp;
+  // the packet buffer is allocated once and kept
+  if (!realtimeOutPacket) realtimeOutPacket = (uint8_t*)malloc(REALTIME_OUT_PACKET_SIZE);
+  if (!realtimeOutPacket) return 1;
 
-  switch (type) {
-    case 0: // DDP
-    {
-      // calculate the number of UDP packets we need to send
-      uint16_t channelCount = length * 3; // 1 channel for every R,G,B value
-      uint16_t packetCount = ((channelCount-1) / DDP_CHANNELS_PER_PACKET) +1;
-
-      // there are 3 channels per RGB pixel
-      uint32_t channel = 0; // TODO: allow specifying the start channel
-      // the current position in the buffer 
-      uint16_t bufferOffset = 0;
-
-      for (uint16_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
-        if (sequenceNumber > 15) sequenceNumber = 0;
-
-        if (!ddpUdp.beginPacket(client, DDP_DEFAULT_PORT)) {  // port defined in ESPAsyncE131.h
-          DEBUG_PRINTLN(F("WiFiUDP.beginPacket returned an error"));
-          return 1; // problem
-        }
-
-        // the amount of data is AFTER the header in the current packet
-        uint16_t packetSize = DDP_CHANNELS_PER_PACKET;
-
-        uint8_t flags = DDP_FLAGS1_VER1;
-        if (currentPacket == (packetCount - 1)) {
-          // last packet, set the push flag
-          // TODO: determine if we want to send an empty push packet to each destination after sending the pixel data
-          flags = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
-          if (channelCount % DDP_CHANNELS_PER_PACKET) {
-            packetSize = channelCount % DDP_CHANNELS_PER_PACKET;
-          }
-        }
-
-        // write the header
-        /*0*/ddpUdp.write(flags);
-        /*1*/ddpUdp.write(sequenceNumber++ & 0x0F); // sequence may be unnecessary unless we are sending twice (as requested in Sync settings)
-        /*2*/ddpUdp.write(0);
-        /*3*/ddpUdp.write(DDP_ID_DISPLAY);
-        // data offset in bytes, 32-bit number, MSB first
-        /*4*/ddpUdp.write(0xFF & (channel >> 24));
-        /*5*/ddpUdp.write(0xFF & (channel >> 16));
-        /*6*/ddpUdp.write(0xFF & (channel >>  8));
-        /*7*/ddpUdp.write(0xFF & (channel      ));
-        // data length in bytes, 16-bit number, MSB first
-        /*8*/ddpUdp.write(0xFF & (packetSize >> 8));
-        /*9*/ddpUdp.write(0xFF & (packetSize     ));
-
-        // write the colors, the write write(const uint8_t *buffer, size_t size) 
-        // function is just a loop internally too
-        for (uint16_t i = 0; i < packetSize; i += 3) {
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // R
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // G
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // B
-          if (isRGBW) bufferOffset++;
-        }
-
-        if (!ddpUdp.endPacket()) {            
-          DEBUG_PRINTLN(F("WiFiUDP.endPacket returned an error"));
-          return 1; // problem
-        }
-
-        channel += packetSize;
-      }
-    } break;
-
-    case 1: //E1.31
-    {
-    } break;
+  static E131Source source;
+  if (!source.name) {
+    memset(source.cid, 0, sizeof(source.cid)); // CID, unique per device
+    memcpy_P(source.cid, PSTR("WLED"), 4);
+    WiFi.macAddress(source.cid + 10);
+    source.name = serverDescription;
+  }
 
-    case 2: //ArtNet
-    {
-    } break;
+  realtimeOutType = type;
+  realtimeOutClient = client;
+  uint16_t syncUniverse = (type != REALTIME_OUT_DDP && e131SendSync) ? E131_OUT_SYNC_UNIVERSE : 0;
+  uint8_t &seq = (type == REALTIME_OUT_DDP) ? sequenceNumber : realtimeOutSeq;
+  if (!realtimeSendFrame(realtimeOutPacket, realtimeOutSend, type, buffer, length, isRGBW, bri, startChannel, seq, source, syncUniverse)) {
+    DEBUG_PRINTLN(F("realtimeBroadcast: sending failed"));
+    return 1; // problem
   }
   return 0;
 }
@@ -66,3 +66,9 @@ uint8_t extractModeName(uint8_t mode, const char *src, char *dest, uint8_t maxLe
   dest[printedChars] = '\0';
   return strlen(dest);
 }
+
+// pixel source of the live LED stream (live_leds.cpp)
+void readBusPixelColors(uint16_t first, uint32_t* colors, uint16_t count)
+{
+  busses.getPixelColors(first, colors, count);
+}
@@ -129,6 +129,8 @@ void WLED::loop()
   handleIR();        // 2nd call to function needed for ESP32 to return valid results -- should be good for ESP8266, too
   handleConnection();
   handleSerial();
+  e131.handleQueue();  // realtime packets received since the last loop
+  ddp.handleQueue();   // both stop at a complete frame, which handleNotifications() shows
   handleNotifications();
   handleTransitions();
 #ifdef WLED_ENABLE_DMX
@@ -324,6 +326,9 @@ void WLED::setup()
 
   Serial.begin(115200);
   Serial.setTimeout(50);
+  #ifdef WLED_ENABLE_ADALIGHT
+  Serial.setRxBufferSize(WLED_SERIAL_RX_BUFFER); //room for the loop to fall behind at high Adalight baud rates
+  #endif
   DEBUG_PRINTLN();
   DEBUG_PRINT(F("---WLED "));
   DEBUG_PRINT(versionString);
@@ -520,8 +525,8 @@ void WLED::initAP(bool resetAP)
     if (udpPort2 > 0 && udpPort2 != ntpLocalPort && udpPort2 != udpPort && udpPort2 != udpRgbPort) {
       udp2Connected = notifier2Udp.begin(udpPort2);
     }
-    e131.begin(false, e131Port, e131Universe, E131_MAX_UNIVERSE_COUNT);
-    ddp.begin(false, DDP_DEFAULT_PORT);
+    e131.begin(false, e131Port, e131Universe, e131NeededUniverses(), e131QueueSize(e131NeededUniverses()));
+    ddp.begin(false, DDP_DEFAULT_PORT, 1, 1, DDP_QUEUE_SIZE);
 
     dnsServer.setErrorReplyCode(DNSReplyCode::NoError);
     dnsServer.start(53, "*", WiFi.softAPIP());
@@ -723,8 +728,8 @@ void WLED::initInterfaces()
 #ifndef WLED_DISABLE_BLYNK
   initBlynk(blynkApiKey, blynkHost, blynkPort);
 #endif
-  e131.begin(e131Multicast, e131Port, e131Universe, E131_MAX_UNIVERSE_COUNT);
-  ddp.begin(false, DDP_DEFAULT_PORT);
+  e131.begin(e131Multicast, e131Port, e131Universe, e131NeededUniverses(), e131QueueSize(e131NeededUniverses()));
+  ddp.begin(false, DDP_DEFAULT_PORT, 1, 1, DDP_QUEUE_SIZE);
   reconnectHue();
   initMqtt();
   interfacesInited = true;
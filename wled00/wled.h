@@ -370,9 +370,12 @@ WLED_GLOBAL uint16_t e131Port _INIT(5568);                        // DMX in port
 WLED_GLOBAL byte DMXMode _INIT(DMX_MODE_MULTIPLE_RGB);            // DMX mode (s.a.)
 WLED_GLOBAL uint16_t DMXAddress _INIT(1);                         // DMX start address of fixture, a.k.a. first Channel [for E1.31 (sACN) protocol]
 WLED_GLOBAL byte DMXOldDimmer _INIT(0);                           // only update brightness on change
-WLED_GLOBAL byte e131LastSequenceNumber[E131_MAX_UNIVERSE_COUNT]; // to detect packet loss
+WLED_GLOBAL byte* e131LastSequenceNumber _INIT(nullptr);         // to detect packet loss, one per universe (s. e131Universes)
+WLED_GLOBAL unsigned long* e131UniverseSeen _INIT(nullptr);       // millis() a universe was last received, 0 if never
+WLED_GLOBAL uint16_t e131Universes _INIT(0);                      // universes allocated for the configured LED count and DMX mode
 WLED_GLOBAL bool e131Multicast _INIT(false);                      // multicast or unicast
 WLED_GLOBAL bool e131SkipOutOfSequence _INIT(false);              // freeze instead of flickering
+WLED_GLOBAL bool e131SendSync _INIT(false);                       // E1.31/Art-Net network busses send sync packets after each frame
 
 WLED_GLOBAL bool mqttEnabled _INIT(false);
 WLED_GLOBAL char mqttDeviceTopic[33] _INIT("");            // main MQTT topic (individual per device, default is wled/mac)
@@ -620,6 +623,24 @@ WLED_GLOBAL WiFiUDP ntpUdp;
 WLED_GLOBAL ESPAsyncE131 e131 _INIT_N(((handleE131Packet)));
 WLED_GLOBAL ESPAsyncE131 ddp  _INIT_N(((handleE131Packet)));
 WLED_GLOBAL bool e131NewData _INIT(false);
+// E1.31/Art-Net frame assembly (s. e131.cpp)
+WLED_GLOBAL byte* e131FrameFlags _INIT(nullptr);       // per universe: received for the current frame / expected per frame
+WLED_GLOBAL uint16_t e131FrameUniverses _INIT(0);      // universes received for the current frame
+WLED_GLOBAL uint16_t e131FrameExpected _INIT(0);       // of those, universes in the expected set
+WLED_GLOBAL uint16_t e131ExpectedUniverses _INIT(0);   // universes the sender transmits per frame
+WLED_GLOBAL uint16_t e131SyncAddress _INIT(0);         // E1.31 sync universe announced in the data packets
+WLED_GLOBAL unsigned long e131LastSync _INIT(0);       // millis() of the last accepted sync packet
+WLED_GLOBAL unsigned long e131LastUniverseAt _INIT(0); // millis() of the last universe of the current frame
+WLED_GLOBAL unsigned long e131FrameStartedAt _INIT(0); // micros() of the first universe of the current frame
+WLED_GLOBAL unsigned long e131FrameReadyAt _INIT(0);   // same for the frame waiting to be shown, 0 if not measured
+WLED_GLOBAL uint32_t e131ShowLatency _INIT(0);         // first universe to show of the last frame [us]
+WLED_GLOBAL uint32_t e131ShowLatencyAvg _INIT(0);      // moving average of the above [us]
+WLED_GLOBAL uint32_t e131FramesShown _INIT(0);        // realtime frames shown, includes DDP
+// realtime ingest statistics
+WLED_GLOBAL uint32_t realtimePackets[] _INIT_N(({0, 0, 0}));    // packets received per protocol (P_E131, P_ARTNET, P_DDP)
+WLED_GLOBAL uint16_t realtimePacketRate[] _INIT_N(({0, 0, 0})); // same per second
+WLED_GLOBAL uint32_t realtimeSeqDropped _INIT(0);      // late/out of sequence packets skipped (e131SkipOutOfSequence)
+WLED_GLOBAL uint32_t realtimeFramesReceived _INIT(0);  // complete frames received, more than shown if frames were merged
 
 // led fx library object
 WLED_GLOBAL BusManager busses _INIT(BusManager());
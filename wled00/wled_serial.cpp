@@ -1,26 +1,15 @@
 #include "wled.h"
+#include "adalight_parser.h"
+#include "live_leds.h"
 
 /*
  * Adalight and TPM2 handler
  */
 
-enum class AdaState {
-  Header_A,
-  Header_d,
-  Header_a,
-  Header_CountHi,
-  Header_CountLo,
-  Header_CountCheck,
-  Data_Red,
-  Data_Green,
-  Data_Blue,
-  TPM2_Header_Type,
-  TPM2_Header_CountHi,
-  TPM2_Header_CountLo,
-};
-
 uint16_t currentBaud = 1152; //default baudrate 115200 (divided by 100)
 
+#define ADALIGHT_CHUNK_PIXELS 64 //pixels copied per Serial.readBytes()
+
 void updateBaudRate(uint32_t rate){
   uint16_t rate100 = rate/100;
   if (rate100 == currentBaud || rate100 < 96) return;
@@ -39,24 +28,32 @@ void handleSerial()
   if (pinManager.isPinAllocated(3)) return;
   
   #ifdef WLED_ENABLE_ADALIGHT
-  static auto state = AdaState::Header_A;
-  static uint16_t count = 0;
-  static uint16_t pixel = 0;
-  static byte check = 0x00;
-  static byte red   = 0x00;
-  static byte green = 0x00;
+  static AdalightParser ada;
 
   while (Serial.available() > 0)
   {
     yield();
+
+    //pixel data: copy whole pixels in bulk, the parser only handles headers and split pixels
+    uint16_t n = ada.bulkPixels();
+    if (n && Serial.available() >= 3) {
+      byte buf[ADALIGHT_CHUNK_PIXELS*3];
+      if (n > Serial.available() / 3) n = Serial.available() / 3;
+      if (n > ADALIGHT_CHUNK_PIXELS) n = ADALIGHT_CHUNK_PIXELS;
+      Serial.readBytes(buf, n*3);
+      if (!realtimeOverride) setRealtimePixels(ada.nextPixel(), buf, n);
+      if (ada.bulkRead(n)) {
+        realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
+        if (!realtimeOverride) strip.show();
+      }
+      continue;
+    }
+
     byte next = Serial.peek();
-    switch (state) {
-      case AdaState::Header_A:
-        if (next == 'A') state = AdaState::Header_d;
-        else if (next == 0xC9) { //TPM2 start byte
-          state = AdaState::TPM2_Header_Type;
-        }
-        else if (next == 'I') {
+    uint8_t event = ada.feed(next);
+    switch (event) {
+      case ADALIGHT_COMMAND:
+        if (next == 'I') {
           handleImprovPacket();
           return;
         } else if (next == 'v') {
@@ -96,6 +93,19 @@ void handleSerial()
             }
             Serial.write(0x36); Serial.write('\n');
           }
+        } else if (next == 'C') { //RGB(W) LED data at full resolution, run-length compressed, see live_leds.h
+          if (!pinManager.isPinAllocated(1) || pinManager.getPinOwner(1) == PinOwner::DebugOut) {
+            uint16_t used = strip.getLengthTotal();
+            bool rgbw = strip.hasRGBWBus();
+            byte msg[LIVE_LEDS_HEADER_LEN + 256];
+            uint16_t pix = 0;
+            do { //split into messages that fit the buffer
+              uint16_t first = pix;
+              uint16_t len = LIVE_LEDS_HEADER_LEN + encodeLiveLeds(msg + LIVE_LEDS_HEADER_LEN, sizeof(msg) - LIVE_LEDS_HEADER_LEN, pix, used, nullptr, rgbw, readBusPixelColors);
+              writeLiveLedsHeader(msg, rgbw, first == 0, strip.getBrightness(), used, first, pix - first);
+              Serial.write(msg, len);
+            } while (pix < used);
+          }
         } else if (next == '{') { //JSON API
           bool verboseResponse = false;
           #ifdef WLED_USE_DYNAMIC_JSON
@@ -124,60 +134,16 @@ void handleSerial()
           releaseJSONBufferLock();
         }
         break;
-      case AdaState::Header_d:
-        if (next == 'd') state = AdaState::Header_a;
-        else             state = AdaState::Header_A;
-        break;
-      case AdaState::Header_a:
-        if (next == 'a') state = AdaState::Header_CountHi;
-        else             state = AdaState::Header_A;
-        break;
-      case AdaState::Header_CountHi:
-        pixel = 0;
-        count = next * 0x100;
-        check = next;
-        state = AdaState::Header_CountLo;
-        break;
-      case AdaState::Header_CountLo:
-        count += next + 1;
-        check = check ^ next ^ 0x55;
-        state = AdaState::Header_CountCheck;
-        break;
-      case AdaState::Header_CountCheck:
-        if (check == next) state = AdaState::Data_Red;
-        else               state = AdaState::Header_A;
-        break;
-      case AdaState::TPM2_Header_Type:
-        state = AdaState::Header_A; //(unsupported) TPM2 command or invalid type
-        if (next == 0xDA) state = AdaState::TPM2_Header_CountHi; //TPM2 data
-        else if (next == 0xAA) Serial.write(0xAC); //TPM2 ping
-        break;
-      case AdaState::TPM2_Header_CountHi:
-        pixel = 0;
-        count = (next * 0x100) /3;
-        state = AdaState::TPM2_Header_CountLo;
-        break;
-      case AdaState::TPM2_Header_CountLo:
-        count += next /3;
-        state = AdaState::Data_Red;
-        break;
-      case AdaState::Data_Red:
-        red   = next;
-        state = AdaState::Data_Green;
-        break;
-      case AdaState::Data_Green:
-        green = next;
-        state = AdaState::Data_Blue;
+      case ADALIGHT_PING:
+        Serial.write(0xAC);
         break;
-      case AdaState::Data_Blue:
-        byte blue  = next;
-        if (!realtimeOverride) setRealtimePixel(pixel++, red, green, blue, 0);
-        if (--count > 0) state = AdaState::Data_Red;
-        else {
+      case ADALIGHT_PIXEL:
+      case ADALIGHT_FRAME:
+        if (!realtimeOverride) setRealtimePixel(ada.pixelIndex(), ada.red, ada.green, ada.blue, 0);
+        if (event == ADALIGHT_FRAME) {
           realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
 
           if (!realtimeOverride) strip.show();
-          state = AdaState::Header_A;
         }
         break;
     }
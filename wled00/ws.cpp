@@ -1,4 +1,5 @@
 #include "wled.h"
+#include "live_leds.h"
 
 /*
  * WebSockets server for bidirectional communication
@@ -7,9 +8,26 @@
 
 uint16_t wsLiveClientId = 0;
 unsigned long wsLastLiveTime = 0;
+bool wsLiveFull = false;           //live client wants the compressed full resolution stream
+uint16_t wsLivePix = 0;            //next pixel to send, non-zero while a frame is split across messages
+uint16_t wsLiveLen = 0;            //pixel count the stream was started with, 0 to restart
+uint32_t* wsLivePrev = nullptr;    //colors last sent on the compressed stream, nullptr if no memory for deltas
+volatile bool wsLiveReset = false; //set by wsEvent() (async TCP task), the stream is reset by handleWs() in the main loop
+uint16_t wsRtStatsClientId = 0;
+unsigned long wsLastRtStatsTime = 0;
 //uint8_t* wsFrameBuffer = nullptr;
 
 #define WS_LIVE_INTERVAL 40
+#define WS_RT_STATS_INTERVAL 1000
+
+//restarts the compressed live stream with its next message and releases the previous colors, main loop only
+static void resetLiveLedsWs()
+{
+  free(wsLivePrev);
+  wsLivePrev = nullptr;
+  wsLivePix = 0;
+  wsLiveLen = 0;
+}
 
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len)
 {
@@ -18,7 +36,8 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
     sendDataWs(client);
   } else if(type == WS_EVT_DISCONNECT){
     //client disconnected
-    if (client->id() == wsLiveClientId) wsLiveClientId = 0;
+    if (client->id() == wsLiveClientId) { wsLiveClientId = 0; wsLiveReset = true; }
+    if (client->id() == wsRtStatsClientId) wsRtStatsClientId = 0;
   } else if(type == WS_EVT_DATA){
     //data packet
     AwsFrameInfo * info = (AwsFrameInfo*)arg;
@@ -52,6 +71,11 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
           } else if (root.containsKey("lv"))
           {
             wsLiveClientId = root["lv"] ? client->id() : 0;
+            wsLiveFull = root["lv"].as<int>() == 2; //{"lv":2} selects the compressed full resolution stream
+            wsLiveReset = true;
+          } else if (root.containsKey("rt"))
+          {
+            wsRtStatsClientId = root["rt"] ? client->id() : 0;
           } else {
             verboseResponse = deserializeState(root);
             if (!interfaceUpdateCallMode) {
@@ -156,8 +180,73 @@ bool sendLiveLedsWs(uint32_t wsClient)
   return true;
 }
 
+// sends {"rt":{...}} with the realtime ingest statistics
+bool sendRtStatsWs(uint32_t wsClient)
+{
+  AsyncWebSocketClient * wsc = ws.client(wsClient);
+  if (!wsc || wsc->queueLength() > 0) return false; //only send if queue free
+
+  AsyncWebSocketMessageBuffer * buffer;
+  { //scope JsonDocument so it releases its buffer
+    #ifdef WLED_USE_DYNAMIC_JSON
+    DynamicJsonDocument doc(JSON_BUFFER_SIZE);
+    #else
+    if (!requestJSONBufferLock(18)) return false;
+    #endif
+    JsonObject rt = doc.createNestedObject("rt");
+    serializeRealtimeStats(rt);
+    size_t len = measureJson(doc);
+    buffer = ws.makeBuffer(len);
+    if (!buffer) {
+      releaseJSONBufferLock();
+      return false;
+    }
+    serializeJson(doc, (char *)buffer->get(), len +1);
+    releaseJSONBufferLock();
+  }
+  wsc->text(buffer);
+  return true;
+}
+
+// sends the next part of the compressed full resolution stream, see live_leds.h for the format
+bool sendLiveLedsFullWs(uint32_t wsClient)
+{
+  AsyncWebSocketClient * wsc = ws.client(wsClient);
+  if (!wsc || wsc->queueLength() > 0) return false; //only send if queue free
+
+  uint16_t used = strip.getLengthTotal();
+  bool reset = (wsLiveLen != used || !used);
+  if (reset) { //(re)start the stream from all black
+    resetLiveLedsWs();
+    wsLiveLen = used;
+    //without enough memory for the previous colors every message is sent in full
+    if (used && ESP.getFreeHeap() > used * sizeof(uint32_t) + MIN_HEAP_SIZE + LIVE_LEDS_MSG_SIZE)
+      wsLivePrev = (uint32_t*)calloc(used, sizeof(uint32_t));
+  }
+
+  uint8_t* msg = (uint8_t*)malloc(LIVE_LEDS_MSG_SIZE);
+  if (!msg) return false;
+  bool rgbw = strip.hasRGBWBus();
+  uint16_t first = wsLivePix;
+  uint16_t len = LIVE_LEDS_HEADER_LEN + encodeLiveLeds(msg + LIVE_LEDS_HEADER_LEN, LIVE_LEDS_MSG_SIZE - LIVE_LEDS_HEADER_LEN, wsLivePix, used, wsLivePrev, rgbw, readBusPixelColors);
+  writeLiveLedsHeader(msg, rgbw, reset, strip.getBrightness(), used, first, wsLivePix - first);
+  AsyncWebSocketMessageBuffer * wsBuf = ws.makeBuffer(msg, len);
+  free(msg);
+  if (!wsBuf) { //out of memory, the colors in wsLivePrev were not sent
+    resetLiveLedsWs();
+    return false;
+  }
+  if (wsLivePix >= used) wsLivePix = 0; //frame complete
+  wsc->binary(wsBuf);
+  return true;
+}
+
 void handleWs()
 {
+  if (wsLiveReset) {
+    wsLiveReset = false;
+    resetLiveLedsWs();
+  }
   if (millis() - wsLastLiveTime > WS_LIVE_INTERVAL)
   {
     #ifdef ESP8266
@@ -167,10 +256,18 @@ void handleWs()
     #endif
     bool success = true;
     if (wsLiveClientId)
-      success = sendLiveLedsWs(wsLiveClientId);
+      success = wsLiveFull ? sendLiveLedsFullWs(wsLiveClientId) : sendLiveLedsWs(wsLiveClientId);
     wsLastLiveTime = millis();
     if (!success) wsLastLiveTime -= 20; //try again in 20ms if failed due to non-empty WS queue
   }
+  else if (wsLiveClientId && wsLiveFull && wsLivePix)
+  {
+    sendLiveLedsFullWs(wsLiveClientId); //rest of a frame that did not fit one message, as soon as the queue is free
+  }
+  if (wsRtStatsClientId && millis() - wsLastRtStatsTime > WS_RT_STATS_INTERVAL)
+  {
+    if (sendRtStatsWs(wsRtStatsClientId)) wsLastRtStatsTime = millis();
+  }
 }
 
 #else
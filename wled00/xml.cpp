@@ -389,14 +389,14 @@ void getSettingsJS(byte subPage, char* dest)
     for (uint8_t s=0; s < busses.getNumBusses(); s++) {
       Bus* bus = busses.getBus(s);
       if (bus == nullptr) continue;
-      char lp[4] = "L0"; lp[2] = 48+s; lp[3] = 0; //ascii 0-9 //strip data pin
-      char lc[4] = "LC"; lc[2] = 48+s; lc[3] = 0; //strip length
-      char co[4] = "CO"; co[2] = 48+s; co[3] = 0; //strip color order
-      char lt[4] = "LT"; lt[2] = 48+s; lt[3] = 0; //strip type
-      char ls[4] = "LS"; ls[2] = 48+s; ls[3] = 0; //strip start LED
-      char cv[4] = "CV"; cv[2] = 48+s; cv[3] = 0; //strip reverse
-      char sl[4] = "SL"; sl[2] = 48+s; sl[3] = 0; //skip 1st LED
-      char rf[4] = "RF"; rf[2] = 48+s; rf[3] = 0; //off refresh
+      char lp[5]; sprintf_P(lp, PSTR("L0%d"), s); //strip data pin (decimal bus number like the settings page, more than 10 with parallel I2S)
+      char lc[5]; sprintf_P(lc, PSTR("LC%d"), s); //strip length
+      char co[5]; sprintf_P(co, PSTR("CO%d"), s); //strip color order
+      char lt[5]; sprintf_P(lt, PSTR("LT%d"), s); //strip type
+      char ls[5]; sprintf_P(ls, PSTR("LS%d"), s); //strip start LED
+      char cv[5]; sprintf_P(cv, PSTR("CV%d"), s); //strip reverse
+      char sl[5]; sprintf_P(sl, PSTR("SL%d"), s); //skip 1st LED
+      char rf[5]; sprintf_P(rf, PSTR("RF%d"), s); //off refresh
       oappend(SET_F("addLEDs(1);"));
       uint8_t pins[5];
       uint8_t nPins = bus->getPins(pins);